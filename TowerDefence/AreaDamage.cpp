@@ -0,0 +1,144 @@
+#include "pch.h"
+#include "AreaDamage.h"
+#include "EnemyWorld.h"
+#include "EnemyGrid.h"
+#include "CircleRenderer.h"
+#include "utils.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // How long blasts and arcs stay on screen
+    const int g_EffectTicks{ 6 };
+}
+
+AreaDamage::AreaDamage()
+    : m_HitCount{ 0 }
+    , m_LastHitCount{ 0 }
+{
+}
+
+void AreaDamage::Begin(const EnemyGrid& grid)
+{
+    m_Damage.assign(grid.GetCount(), 0.f);
+    m_Touched.clear();
+    m_HitCount = 0;
+    size_t kept = 0;
+    for (const Effect& effect : m_Effects)
+    {
+        if (effect.ticksLeft <= 1) continue;
+        m_Effects[kept] = effect;
+        --m_Effects[kept++].ticksLeft;
+    }
+    m_Effects.resize(kept);
+}
+
+void AreaDamage::AddHit(uint32_t entry, float damage)
+{
+    if (m_Damage[entry] == 0.f) m_Touched.push_back(entry);
+    m_Damage[entry] += damage;
+    ++m_HitCount;
+}
+
+void AreaDamage::AddEffect(const Vector2f& from, const Vector2f& to, float radius)
+{
+    m_Effects.push_back(Effect{ from, to, radius, g_EffectTicks });
+}
+
+void AreaDamage::AddBlast(const EnemyWorld& world, const EnemyGrid& grid, const Vector2f& center, float radius,
+    float damage, EnemyHandle skip)
+{
+    if (radius <= 0.f || damage <= 0.f) return;
+    grid.QueryInto(center, radius, m_Scratch);
+    const std::vector<EnemyGrid::Entry>& entries = grid.GetEntries();
+    for (uint32_t index : m_Scratch)
+    {
+        const EnemyGrid::Entry& entry = entries[index];
+        const EnemyArchetype& archetype = world.GetArchetype(entry.type);
+        // Enemies the pending damage already kills are left alone
+        if (archetype.healths[entry.row].health <= m_Damage[index] || archetype.handles[entry.row] == skip) continue;
+        AddHit(index, damage);
+    }
+    AddEffect(center, center, radius);
+}
+
+void AreaDamage::AddChain(const EnemyWorld& world, const EnemyGrid& grid, const Vector2f& from, EnemyHandle first,
+    int jumps, float range, float damage, float falloff)
+{
+    if (jumps <= 0 || damage <= 0.f) return;
+    const std::vector<EnemyGrid::Entry>& entries = grid.GetEntries();
+    m_Struck.clear();
+    m_Struck.push_back(first.value);
+    Vector2f position = from;
+    for (int jump = 0; jump < jumps; ++jump)
+    {
+        damage *= falloff;
+        grid.QueryInto(position, range, m_Scratch);
+        uint32_t next = std::numeric_limits<uint32_t>::max();
+        float nextDistance = std::numeric_limits<float>::max();
+        for (uint32_t index : m_Scratch)
+        {
+            const EnemyGrid::Entry& entry = entries[index];
+            const EnemyArchetype& archetype = world.GetArchetype(entry.type);
+            if (archetype.healths[entry.row].health <= m_Damage[index]) continue;
+            if (std::find(m_Struck.begin(), m_Struck.end(), archetype.handles[entry.row].value) != m_Struck.end()) continue;
+            float dx = entry.position.x - position.x;
+            float dy = entry.position.y - position.y;
+            float distance = dx * dx + dy * dy;
+            if (distance < nextDistance)
+            {
+                nextDistance = distance;
+                next = index;
+            }
+        }
+        if (next == std::numeric_limits<uint32_t>::max()) return;
+
+        const EnemyGrid::Entry& entry = entries[next];
+        AddHit(next, damage);
+        AddEffect(position, entry.position, 0.f);
+        m_Struck.push_back(world.GetArchetype(entry.type).handles[entry.row].value);
+        position = entry.position;
+    }
+}
+
+void AreaDamage::Apply(EnemyWorld& world, const EnemyGrid& grid)
+{
+    const std::vector<EnemyGrid::Entry>& entries = grid.GetEntries();
+    for (uint32_t index : m_Touched)
+    {
+        const EnemyGrid::Entry& entry = entries[index];
+        HealthComponent& health = world.GetArchetype(entry.type).healths[entry.row];
+        health.health = std::max(0.f, health.health - m_Damage[index]);
+        m_Damage[index] = 0.f;
+    }
+    m_Touched.clear();
+    m_LastHitCount = m_HitCount;
+}
+
+void AreaDamage::Clear()
+{
+    std::fill(m_Damage.begin(), m_Damage.end(), 0.f);
+    m_Touched.clear();
+    m_Effects.clear();
+    m_HitCount = 0;
+    m_LastHitCount = 0;
+}
+
+void AreaDamage::Draw(CircleRenderer& circles) const
+{
+    for (const Effect& effect : m_Effects)
+    {
+        float alpha = static_cast<float>(effect.ticksLeft) / g_EffectTicks;
+        if (effect.radius > 0.f)
+        {
+            circles.Outline(effect.from, effect.radius, effect.radius, Color4f(1.f, 0.55f, 0.1f, 0.8f * alpha), 2.f);
+        }
+        else
+        {
+            utils::SetColor(Color4f(0.6f, 0.85f, 1.f, alpha));
+            utils::DrawLine(effect.from, effect.to, 2.f);
+        }
+    }
+    circles.Flush();
+}
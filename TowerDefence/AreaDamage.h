@@ -0,0 +1,68 @@
+#pragma once
+#include "structs.h"
+#include "EnemyHandle.h"
+#include <vector>
+#include <cstdint>
+
+class EnemyWorld;
+class EnemyGrid;
+class CircleRenderer;
+
+// Splash, explosion and chain lightning damage for one tick. Every area hit
+// finds its victims with EnemyGrid::QueryInto into a scratch buffer and only
+// adds to a per grid entry total; Apply then subtracts the totals from the
+// enemies in one pass. All buffers keep their capacity, so after warm-up a
+// tick full of area hits costs no allocations. Grid entry indices are only
+// valid until the world changes structurally, so Begin and Apply have to
+// bracket the hits inside one system.
+class AreaDamage
+{
+public:
+    AreaDamage();
+    AreaDamage(const AreaDamage& other) = delete;
+    AreaDamage& operator=(const AreaDamage& other) = delete;
+
+    // Sizes the totals for the grid built this tick
+    void Begin(const EnemyGrid& grid);
+    // Damage to every living enemy touching the circle except skip
+    void AddBlast(const EnemyWorld& world, const EnemyGrid& grid, const Vector2f& center, float radius,
+        float damage, EnemyHandle skip);
+    // Lightning jumps from the enemy hit at from to the nearest living enemy
+    // within range that it has not struck yet, up to jumps times, each jump
+    // dealing falloff times the damage of the one before
+    void AddChain(const EnemyWorld& world, const EnemyGrid& grid, const Vector2f& from, EnemyHandle first,
+        int jumps, float range, float damage, float falloff);
+    // Subtracts the totals in the order the enemies were first hit
+    void Apply(EnemyWorld& world, const EnemyGrid& grid);
+
+    // Area hits applied by the last Apply, for the profiler overlay
+    uint32_t GetLastHitCount() const { return m_LastHitCount; }
+
+    // Blast rings and lightning arcs of the last few ticks
+    void Draw(CircleRenderer& circles) const;
+    // Forgets the pending totals and the effects
+    void Clear();
+
+private:
+    struct Effect
+    {
+        Vector2f from;
+        Vector2f to;
+        // Blasts only use from and radius, arcs only from and to
+        float radius;
+        int ticksLeft;
+    };
+
+    void AddHit(uint32_t entry, float damage);
+    void AddEffect(const Vector2f& from, const Vector2f& to, float radius);
+
+    // Pending damage per grid entry, and the entries with any
+    std::vector<float> m_Damage;
+    std::vector<uint32_t> m_Touched;
+    uint32_t m_HitCount;
+    uint32_t m_LastHitCount;
+    // Reused query results and the enemies a chain has already struck
+    std::vector<uint32_t> m_Scratch;
+    std::vector<uint32_t> m_Struck;
+    std::vector<Effect> m_Effects;
+};
@@ -2,10 +2,12 @@
 #include "Bullet.h"
 #include "utils.h"
 #include <cmath>
-#include "EnemyBase.h"
+#include "Snapshot.h"
+#include "CircleRenderer.h"
 
 Bullet::Bullet(float x, float y, float targetX, float targetY, float speed, int damage, int hp)
     : m_Position{ x, y },
+    m_PreviousPosition{ x, y },
     m_Direction{ 0, 0 },
     m_Speed(speed),
     m_Damage(damage),
@@ -31,22 +33,13 @@ Bullet::Bullet(float x, float y, float targetX, float targetY, float speed, int
     }
 }
 
-void Bullet::Draw() const
+void Bullet::Draw(CircleRenderer& circles) const
 {
     if (m_IsActive)
     {
-       
-        if (m_HP > 1)
-        {
-         
-            utils::SetColor(Color4f(0.5f, 0.8f, 1.0f, 1.0f));
-        }
-        else
-        {
-
-            utils::SetColor(Color4f(1.f, 1.f, 0.f, 1.f));
-        }
-        utils::FillEllipse(m_Position, m_Radius, m_Radius);
+        // Bullets that can still bounce are blue
+        const Color4f color = m_HP > 1 ? Color4f(0.5f, 0.8f, 1.0f, 1.0f) : Color4f(1.f, 1.f, 0.f, 1.f);
+        circles.Fill(m_Position, m_Radius, m_Radius, color);
     }
 }
 
@@ -54,6 +47,7 @@ void Bullet::Update(float elapsedSec, float windowWidth, float windowHeight)
 {
     if (m_IsActive)
     {
+        m_PreviousPosition = m_Position;
         m_Position.x += m_Direction.x * m_Speed * elapsedSec;
         m_Position.y += m_Direction.y * m_Speed * elapsedSec;
         if (m_Position.x < -50 || m_Position.x > windowWidth + 50 ||
@@ -78,6 +72,37 @@ bool Bullet::CheckHit(const Ellipsef& target) const {
     return (dx * dx + dy * dy) <= 1.0f;
 }
 
+bool Bullet::CheckSweptHit(const Ellipsef& target, float& hitTime) const
+{
+    return m_IsActive && SweepEllipse(m_PreviousPosition, m_Position, target, hitTime);
+}
+
+bool Bullet::SweepEllipse(const Vector2f& from, const Vector2f& to, const Ellipsef& shape, float& hitTime)
+{
+    // Scaled so the ellipse becomes the unit circle, which leaves a quadratic
+    // in the fraction t along the segment: a t^2 + 2b t + c = 0
+    float startX = (from.x - shape.center.x) / shape.radiusX;
+    float startY = (from.y - shape.center.y) / shape.radiusY;
+    float c = startX * startX + startY * startY - 1.f;
+    if (c <= 0.f)
+    {
+        hitTime = 0.f;
+        return true;
+    }
+    float stepX = (to.x - from.x) / shape.radiusX;
+    float stepY = (to.y - from.y) / shape.radiusY;
+    float a = stepX * stepX + stepY * stepY;
+    float b = startX * stepX + startY * stepY;
+    // Not moving, or moving away
+    if (a <= 0.f || b >= 0.f) return false;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.f) return false;
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.f) return false;
+    hitTime = t;
+    return true;
+}
+
 int Bullet::GetDamage() const
 {
     return m_Damage;
@@ -99,4 +124,50 @@ void Bullet::SetTarget(float targetX, float targetY)
         m_Direction.x = 0;
         m_Direction.y = 0;
     }
-}
\ No newline at end of file
+}
+
+void Bullet::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteVector(m_Position);
+    writer.WriteVector(m_PreviousPosition);
+    writer.WriteVector(m_Direction);
+    writer.WriteFloat(m_Speed);
+    writer.WriteInt(m_Damage);
+    writer.WriteBool(m_IsActive);
+    writer.WriteInt(m_HP);
+    writer.WriteU32(m_Target.value);
+    writer.WriteU32(m_LastHit.value);
+}
+
+void Bullet::ReadState(SnapshotReader& reader)
+{
+    m_Position = reader.ReadVector();
+    m_PreviousPosition = reader.ReadVector();
+    m_Direction = reader.ReadVector();
+    m_Speed = reader.ReadFloat();
+    m_Damage = reader.ReadInt();
+    m_IsActive = reader.ReadBool();
+    m_HP = reader.ReadInt();
+    m_Target.value = reader.ReadU32();
+    m_LastHit.value = reader.ReadU32();
+}
+
+void Bullet::WriteBullets(SnapshotWriter& writer, const std::vector<Bullet>& bullets)
+{
+    writer.WriteU32(static_cast<uint32_t>(bullets.size()));
+    for (const Bullet& bullet : bullets)
+    {
+        bullet.WriteState(writer);
+    }
+}
+
+void Bullet::ReadBullets(SnapshotReader& reader, std::vector<Bullet>& bullets)
+{
+    uint32_t count = reader.ReadU32();
+    bullets.clear();
+    for (uint32_t i = 0; i < count && reader.IsOk(); ++i)
+    {
+        bullets.emplace_back(0.f, 0.f, 0.f, 0.f, 0.f, 0);
+        bullets.back().ReadState(reader);
+    }
+}
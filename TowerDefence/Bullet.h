@@ -1,5 +1,11 @@
 #pragma once
 #include "structs.h" 
+#include "EnemyHandle.h"
+#include <vector>
+
+class SnapshotWriter;
+class CircleRenderer;
+class SnapshotReader;
 
 class Bullet
 {
@@ -11,19 +17,29 @@ public:
         if (this != &other)
         {
             m_Position = other.m_Position;
+            m_PreviousPosition = other.m_PreviousPosition;
             m_Direction = other.m_Direction;
             m_Speed = other.m_Speed;
             m_Damage = other.m_Damage;
             m_IsActive = other.m_IsActive;
             m_HP = other.m_HP;
+            m_Target = other.m_Target;
+            m_LastHit = other.m_LastHit;
         }
         return *this;
     }
     void Deactivate() { m_IsActive = false; }
-    void Draw() const;
+    void Draw(CircleRenderer& circles) const;
     void Update(float elapsedSec, float windowWidth, float windowHeight);
     bool IsActive() const;
     bool CheckHit(const Ellipsef& enemyShape) const;
+    // Swept test along the last step, from the previous position to the
+    // current one, so fast bullets and long ticks cannot skip past a target.
+    // hitTime is the fraction of the step at first contact.
+    bool CheckSweptHit(const Ellipsef& enemyShape, float& hitTime) const;
+    Vector2f GetPreviousPosition() const { return m_PreviousPosition; }
+    // Restarts the next step from here, e.g. the point a ricochet bounced off
+    void MoveTo(const Vector2f& position) { m_Position = position; m_PreviousPosition = position; }
     int GetDamage() const;
     Vector2f GetPosition() const { return m_Position; }
     float GetSpeed() const { return m_Speed; }
@@ -32,13 +48,31 @@ public:
     int GetHP() const { return m_HP; }
     void TakeDamage() { m_HP--; if (m_HP <= 0) m_IsActive = false; }
     void SetTarget(float targetX, float targetY);
+    // Enemy the bullet keeps steering towards, null when it flies straight
+    void SetHomingTarget(EnemyHandle target) { m_Target = target; }
+    EnemyHandle GetHomingTarget() const { return m_Target; }
+    // The enemy hit last, which a ricochet must not hit again straight away
+    void SetLastHit(EnemyHandle enemy) { m_LastHit = enemy; }
+    EnemyHandle GetLastHit() const { return m_LastHit; }
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+    static void WriteBullets(SnapshotWriter& writer, const std::vector<Bullet>& bullets);
+    static void ReadBullets(SnapshotReader& reader, std::vector<Bullet>& bullets);
+
+    // Earliest contact of the segment from -> to with the ellipse, as a
+    // fraction of the segment; 0 when it starts inside
+    static bool SweepEllipse(const Vector2f& from, const Vector2f& to, const Ellipsef& shape, float& hitTime);
 
 private:
     Vector2f m_Position;
+    Vector2f m_PreviousPosition;
     Vector2f m_Direction;
     float m_Speed;
     int m_Damage;
     bool m_IsActive;
     int m_HP;  
+    EnemyHandle m_Target;
+    EnemyHandle m_LastHit;
     const float m_Radius{ 5.f };
 };
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "BulletPattern.h"
+#include "ProjectileStore.h"
+#include "Random.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Ordered by the power level that unlocks them. Bosses reach power level
+    // 2 on wave 5 and one more every five waves.
+    const BulletPattern g_Patterns[]{
+        // shape                minLevel bullets perLevel arc    spin   volleys delay  speed damage
+        { PatternShape::Aimed,  1,       1,      0,       0.3f,  0.f,   0,      0.f,   1.f,  1.f },
+        { PatternShape::Fan,    3,       5,      2,       0.9f,  0.f,   3,      0.3f,  0.9f, 0.5f },
+        { PatternShape::Ring,   4,       16,     8,       0.f,   0.13f, 3,      0.45f, 0.7f, 0.5f },
+        { PatternShape::Spiral, 5,       3,      1,       0.f,   0.21f, 40,     0.05f, 0.8f, 0.25f },
+    };
+    const int g_PatternCount{ sizeof(g_Patterns) / sizeof(g_Patterns[0]) };
+
+    const float g_Pi{ 3.14159265f };
+}
+
+const BulletPattern& BulletPatterns::Select(int powerLevel, int burstIndex)
+{
+    int unlocked = 0;
+    while (unlocked < g_PatternCount && g_Patterns[unlocked].minPowerLevel <= powerLevel) ++unlocked;
+    if (unlocked == 0) return g_Patterns[0];
+    return g_Patterns[burstIndex % unlocked];
+}
+
+void BulletPatterns::EmitVolley(const BulletPattern& pattern, int powerLevel, int volley, const Vector2f& origin,
+    float aimAngle, float speed, float damage, ProjectileStore& projectiles)
+{
+    const int count = pattern.bullets + pattern.bulletsPerLevel * std::max(0, powerLevel - pattern.minPowerLevel);
+    const float bulletSpeed = speed * pattern.speedScale;
+    const int bulletDamage = std::max(1, static_cast<int>(damage * pattern.damageScale));
+
+    if (pattern.shape == PatternShape::Aimed)
+    {
+        // Spread shrinks as the boss gets stronger
+        float angleVariance = pattern.arc / std::sqrt(float(powerLevel));
+        for (int i = 0; i < count; ++i)
+        {
+            float angle = aimAngle + (Random::NextFloat() - 0.5f) * angleVariance;
+            projectiles.Emit(origin, Vector2f{ std::cos(angle) * bulletSpeed, std::sin(angle) * bulletSpeed }, bulletDamage);
+        }
+        return;
+    }
+
+    float first = 0.f;
+    float step = 0.f;
+    if (pattern.shape == PatternShape::Fan)
+    {
+        first = aimAngle - pattern.arc * 0.5f;
+        step = count > 1 ? pattern.arc / (count - 1) : 0.f;
+        if (count == 1) first = aimAngle;
+    }
+    else
+    {
+        first = aimAngle + pattern.spin * volley;
+        step = 2.f * g_Pi / count;
+    }
+
+    // Rotate one velocity by the step instead of a sin and cos per bullet
+    Vector2f velocity{ std::cos(first) * bulletSpeed, std::sin(first) * bulletSpeed };
+    const float stepCos = std::cos(step);
+    const float stepSin = std::sin(step);
+    for (int i = 0; i < count; ++i)
+    {
+        projectiles.Emit(origin, velocity, bulletDamage);
+        velocity = Vector2f{ velocity.x * stepCos - velocity.y * stepSin, velocity.x * stepSin + velocity.y * stepCos };
+    }
+}
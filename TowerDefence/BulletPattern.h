@@ -0,0 +1,48 @@
+#pragma once
+#include "structs.h"
+#include <cstdint>
+
+class ProjectileStore;
+
+enum class PatternShape : uint8_t
+{
+    // One bullet at the tower with a random spread per shot
+    Aimed,
+    // Bullets spread evenly over an arc centred on the tower
+    Fan,
+    // Bullets evenly around the full circle
+    Ring,
+    // A ring of arms that turns a little every volley
+    Spiral
+};
+
+// One boss attack: a number of volleys, each emitting a shape of bullets.
+// Counts grow with the boss power level, so later bosses fill the screen.
+struct BulletPattern
+{
+    PatternShape shape;
+    // Lowest boss power level that uses the pattern
+    int minPowerLevel;
+    int bullets;
+    int bulletsPerLevel;
+    // Fan width, or the random spread of aimed shots at power level 1, in radians
+    float arc;
+    // Rotation added every volley, in radians
+    float spin;
+    // Zero means the boss's own burst count and burst delay
+    int volleys;
+    float volleyDelay;
+    float speedScale;
+    float damageScale;
+};
+
+namespace BulletPatterns
+{
+    // The burstIndex-th attack of a boss cycles through every pattern its
+    // power level has unlocked
+    const BulletPattern& Select(int powerLevel, int burstIndex);
+
+    // Emits one volley; aimAngle points at the target
+    void EmitVolley(const BulletPattern& pattern, int powerLevel, int volley, const Vector2f& origin,
+        float aimAngle, float speed, float damage, ProjectileStore& projectiles);
+}
@@ -0,0 +1,254 @@
+#include "pch.h"
+#include "CircleRenderer.h"
+#include "utils.h"
+#include <iostream>
+
+namespace
+{
+    const char* g_VertexShader = R"(#version 120
+attribute vec4 shape;
+attribute float lineWidth;
+varying vec4 v_Shape;
+varying float v_LineWidth;
+void main()
+{
+    v_Shape = shape;
+    v_LineWidth = lineWidth;
+    gl_FrontColor = gl_Color;
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+}
+)";
+
+    // The ellipse's implicit function divided by its gradient approximates the
+    // distance to the edge in pixels; fwidth turns it into one pixel of coverage
+    const char* g_FragmentShader = R"(#version 120
+varying vec4 v_Shape;
+varying float v_LineWidth;
+void main()
+{
+    vec2 offset = v_Shape.xy;
+    vec2 radius = v_Shape.zw;
+    float k0 = length(offset / radius);
+    float k1 = length(offset / (radius * radius));
+    float distance = k1 > 0.0 ? k0 * (k0 - 1.0) / k1 : -min(radius.x, radius.y);
+    if (v_LineWidth > 0.0) distance = abs(distance) - v_LineWidth * 0.5;
+    float coverage = clamp(0.5 - distance / max(fwidth(distance), 0.0001), 0.0, 1.0);
+    gl_FragColor = vec4(gl_Color.rgb, gl_Color.a * coverage);
+}
+)";
+
+    // Room outside the shape for the outline and the anti-aliased edge
+    const float g_EdgeMargin{ 1.5f };
+}
+
+// OpenGL 2.0 entry points, which opengl32.dll on Windows does not export
+struct CircleRenderer::ShaderFunctions
+{
+    PFNGLCREATESHADERPROC createShader;
+    PFNGLSHADERSOURCEPROC shaderSource;
+    PFNGLCOMPILESHADERPROC compileShader;
+    PFNGLGETSHADERIVPROC getShaderiv;
+    PFNGLGETSHADERINFOLOGPROC getShaderInfoLog;
+    PFNGLDELETESHADERPROC deleteShader;
+    PFNGLCREATEPROGRAMPROC createProgram;
+    PFNGLATTACHSHADERPROC attachShader;
+    PFNGLLINKPROGRAMPROC linkProgram;
+    PFNGLGETPROGRAMIVPROC getProgramiv;
+    PFNGLGETPROGRAMINFOLOGPROC getProgramInfoLog;
+    PFNGLDELETEPROGRAMPROC deleteProgram;
+    PFNGLUSEPROGRAMPROC useProgram;
+    PFNGLGETATTRIBLOCATIONPROC getAttribLocation;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC enableVertexAttribArray;
+    PFNGLDISABLEVERTEXATTRIBARRAYPROC disableVertexAttribArray;
+    PFNGLVERTEXATTRIBPOINTERPROC vertexAttribPointer;
+
+    bool Load()
+    {
+        createShader = reinterpret_cast<PFNGLCREATESHADERPROC>(SDL_GL_GetProcAddress("glCreateShader"));
+        shaderSource = reinterpret_cast<PFNGLSHADERSOURCEPROC>(SDL_GL_GetProcAddress("glShaderSource"));
+        compileShader = reinterpret_cast<PFNGLCOMPILESHADERPROC>(SDL_GL_GetProcAddress("glCompileShader"));
+        getShaderiv = reinterpret_cast<PFNGLGETSHADERIVPROC>(SDL_GL_GetProcAddress("glGetShaderiv"));
+        getShaderInfoLog = reinterpret_cast<PFNGLGETSHADERINFOLOGPROC>(SDL_GL_GetProcAddress("glGetShaderInfoLog"));
+        deleteShader = reinterpret_cast<PFNGLDELETESHADERPROC>(SDL_GL_GetProcAddress("glDeleteShader"));
+        createProgram = reinterpret_cast<PFNGLCREATEPROGRAMPROC>(SDL_GL_GetProcAddress("glCreateProgram"));
+        attachShader = reinterpret_cast<PFNGLATTACHSHADERPROC>(SDL_GL_GetProcAddress("glAttachShader"));
+        linkProgram = reinterpret_cast<PFNGLLINKPROGRAMPROC>(SDL_GL_GetProcAddress("glLinkProgram"));
+        getProgramiv = reinterpret_cast<PFNGLGETPROGRAMIVPROC>(SDL_GL_GetProcAddress("glGetProgramiv"));
+        getProgramInfoLog = reinterpret_cast<PFNGLGETPROGRAMINFOLOGPROC>(SDL_GL_GetProcAddress("glGetProgramInfoLog"));
+        deleteProgram = reinterpret_cast<PFNGLDELETEPROGRAMPROC>(SDL_GL_GetProcAddress("glDeleteProgram"));
+        useProgram = reinterpret_cast<PFNGLUSEPROGRAMPROC>(SDL_GL_GetProcAddress("glUseProgram"));
+        getAttribLocation = reinterpret_cast<PFNGLGETATTRIBLOCATIONPROC>(SDL_GL_GetProcAddress("glGetAttribLocation"));
+        enableVertexAttribArray = reinterpret_cast<PFNGLENABLEVERTEXATTRIBARRAYPROC>(SDL_GL_GetProcAddress("glEnableVertexAttribArray"));
+        disableVertexAttribArray = reinterpret_cast<PFNGLDISABLEVERTEXATTRIBARRAYPROC>(SDL_GL_GetProcAddress("glDisableVertexAttribArray"));
+        vertexAttribPointer = reinterpret_cast<PFNGLVERTEXATTRIBPOINTERPROC>(SDL_GL_GetProcAddress("glVertexAttribPointer"));
+        return createShader && shaderSource && compileShader && getShaderiv && getShaderInfoLog && deleteShader &&
+            createProgram && attachShader && linkProgram && getProgramiv && getProgramInfoLog && deleteProgram &&
+            useProgram && getAttribLocation && enableVertexAttribArray && disableVertexAttribArray && vertexAttribPointer;
+    }
+
+    // 0 when it does not compile; the log goes to cerr
+    GLuint Compile(GLenum type, const char* source)
+    {
+        GLuint shader = createShader(type);
+        shaderSource(shader, 1, &source, nullptr);
+        compileShader(shader);
+        GLint compiled = GL_FALSE;
+        getShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if (compiled == GL_TRUE) return shader;
+        char log[1024]{};
+        getShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "CircleRenderer: shader does not compile: " << log << std::endl;
+        deleteShader(shader);
+        return 0;
+    }
+};
+
+CircleRenderer::CircleRenderer()
+    : m_pFunctions{ new ShaderFunctions{} }
+    , m_Program{ 0 }
+    , m_ShapeAttribute{ -1 }
+    , m_LineWidthAttribute{ -1 }
+    , m_Enabled{ false }
+    , m_ShapeCount{ 0 }
+    , m_DrawCallCount{ 0 }
+    , m_LastFrameShapeCount{ 0 }
+    , m_LastFrameDrawCallCount{ 0 }
+{
+    if (!BuildProgram())
+        std::cerr << "CircleRenderer: shaders unavailable, drawing tessellated circles" << std::endl;
+    m_Enabled = IsAvailable();
+}
+
+CircleRenderer::~CircleRenderer()
+{
+    if (m_Program != 0) m_pFunctions->deleteProgram(m_Program);
+    delete m_pFunctions;
+    m_pFunctions = nullptr;
+}
+
+bool CircleRenderer::BuildProgram()
+{
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
+    if (!version || !m_pFunctions->Load()) return false;
+
+    GLuint vertexShader = m_pFunctions->Compile(GL_VERTEX_SHADER, g_VertexShader);
+    GLuint fragmentShader = m_pFunctions->Compile(GL_FRAGMENT_SHADER, g_FragmentShader);
+    if (vertexShader == 0 || fragmentShader == 0)
+    {
+        if (vertexShader != 0) m_pFunctions->deleteShader(vertexShader);
+        if (fragmentShader != 0) m_pFunctions->deleteShader(fragmentShader);
+        return false;
+    }
+    GLuint program = m_pFunctions->createProgram();
+    m_pFunctions->attachShader(program, vertexShader);
+    m_pFunctions->attachShader(program, fragmentShader);
+    m_pFunctions->linkProgram(program);
+    // The program keeps the shaders alive as long as it needs them
+    m_pFunctions->deleteShader(vertexShader);
+    m_pFunctions->deleteShader(fragmentShader);
+
+    GLint linked = GL_FALSE;
+    m_pFunctions->getProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        char log[1024]{};
+        m_pFunctions->getProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::cerr << "CircleRenderer: shaders do not link: " << log << std::endl;
+        m_pFunctions->deleteProgram(program);
+        return false;
+    }
+    m_ShapeAttribute = m_pFunctions->getAttribLocation(program, "shape");
+    m_LineWidthAttribute = m_pFunctions->getAttribLocation(program, "lineWidth");
+    if (m_ShapeAttribute < 0 || m_LineWidthAttribute < 0)
+    {
+        m_pFunctions->deleteProgram(program);
+        return false;
+    }
+    m_Program = program;
+    return true;
+}
+
+void CircleRenderer::SetEnabled(bool enabled)
+{
+    Flush();
+    m_Enabled = enabled && IsAvailable();
+}
+
+void CircleRenderer::Fill(const Vector2f& center, float radiusX, float radiusY, const Color4f& color)
+{
+    if (m_Enabled)
+    {
+        Add(center, radiusX, radiusY, color, 0.f);
+        return;
+    }
+    utils::SetColor(color);
+    utils::FillEllipse(center, radiusX, radiusY);
+    ++m_ShapeCount;
+    ++m_DrawCallCount;
+}
+
+void CircleRenderer::Fill(const Ellipsef& shape, const Color4f& color)
+{
+    Fill(shape.center, shape.radiusX, shape.radiusY, color);
+}
+
+void CircleRenderer::Outline(const Vector2f& center, float radiusX, float radiusY, const Color4f& color, float lineWidth)
+{
+    if (m_Enabled)
+    {
+        Add(center, radiusX, radiusY, color, lineWidth);
+        return;
+    }
+    utils::SetColor(color);
+    utils::DrawEllipse(center, radiusX, radiusY, lineWidth);
+    ++m_ShapeCount;
+    ++m_DrawCallCount;
+}
+
+void CircleRenderer::Add(const Vector2f& center, float radiusX, float radiusY, const Color4f& color, float lineWidth)
+{
+    if (radiusX <= 0.f || radiusY <= 0.f) return;
+    const float extentX = radiusX + lineWidth * 0.5f + g_EdgeMargin;
+    const float extentY = radiusY + lineWidth * 0.5f + g_EdgeMargin;
+    const float corners[4][2]{ { -1.f, -1.f }, { 1.f, -1.f }, { 1.f, 1.f }, { -1.f, 1.f } };
+    for (const float* corner : corners)
+    {
+        const float offsetX = corner[0] * extentX;
+        const float offsetY = corner[1] * extentY;
+        m_Vertices.push_back(Vertex{ center.x + offsetX, center.y + offsetY, color, offsetX, offsetY, radiusX, radiusY, lineWidth });
+    }
+    ++m_ShapeCount;
+}
+
+void CircleRenderer::Flush()
+{
+    if (m_Vertices.empty()) return;
+    const GLsizei stride = sizeof(Vertex);
+    m_pFunctions->useProgram(m_Program);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, stride, &m_Vertices[0].x);
+    glColorPointer(4, GL_FLOAT, stride, &m_Vertices[0].color.r);
+    m_pFunctions->enableVertexAttribArray(m_ShapeAttribute);
+    m_pFunctions->enableVertexAttribArray(m_LineWidthAttribute);
+    m_pFunctions->vertexAttribPointer(m_ShapeAttribute, 4, GL_FLOAT, GL_FALSE, stride, &m_Vertices[0].offsetX);
+    m_pFunctions->vertexAttribPointer(m_LineWidthAttribute, 1, GL_FLOAT, GL_FALSE, stride, &m_Vertices[0].lineWidth);
+
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(m_Vertices.size()));
+
+    m_pFunctions->disableVertexAttribArray(m_LineWidthAttribute);
+    m_pFunctions->disableVertexAttribArray(m_ShapeAttribute);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    m_pFunctions->useProgram(0);
+    m_Vertices.clear();
+    ++m_DrawCallCount;
+}
+
+void CircleRenderer::BeginFrame()
+{
+    m_LastFrameShapeCount = m_ShapeCount;
+    m_LastFrameDrawCallCount = m_DrawCallCount;
+    m_ShapeCount = 0;
+    m_DrawCallCount = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+#include <cstdint>
+
+// Filled and outlined circles and ellipses, batched. Each shape is one quad
+// whose fragment shader (GLSL 1.20) computes the distance to the ellipse
+// edge, which gives anti-aliased fills and outlines of any width without
+// tessellating; everything queued between two flushes is a single draw
+// call. The shaders only need OpenGL 2.0 and GLSL 1.20, which the engine's
+// 2.1 context provides. Where they fail to build, or while the renderer is
+// disabled, every shape is drawn right away with utils instead.
+class CircleRenderer
+{
+public:
+    CircleRenderer();
+    ~CircleRenderer();
+    CircleRenderer(const CircleRenderer& other) = delete;
+    CircleRenderer& operator=(const CircleRenderer& other) = delete;
+
+    bool IsAvailable() const { return m_Program != 0; }
+    bool IsEnabled() const { return m_Enabled; }
+    // Has no effect while the shaders are unavailable
+    void SetEnabled(bool enabled);
+
+    void Fill(const Vector2f& center, float radiusX, float radiusY, const Color4f& color);
+    void Fill(const Ellipsef& shape, const Color4f& color);
+    void Outline(const Vector2f& center, float radiusX, float radiusY, const Color4f& color, float lineWidth);
+    // Draws everything queued since the last flush, in the order it was queued
+    void Flush();
+
+    // Starts counting a new frame's shapes and draw calls
+    void BeginFrame();
+    size_t GetLastFrameShapeCount() const { return m_LastFrameShapeCount; }
+    size_t GetLastFrameDrawCallCount() const { return m_LastFrameDrawCallCount; }
+
+private:
+    struct ShaderFunctions;
+    struct Vertex
+    {
+        float x;
+        float y;
+        Color4f color;
+        // Offset from the centre in pixels, then the radii
+        float offsetX;
+        float offsetY;
+        float radiusX;
+        float radiusY;
+        // 0 for a fill
+        float lineWidth;
+    };
+
+    bool BuildProgram();
+    void Add(const Vector2f& center, float radiusX, float radiusY, const Color4f& color, float lineWidth);
+
+    ShaderFunctions* m_pFunctions;
+    uint32_t m_Program;
+    int m_ShapeAttribute;
+    int m_LineWidthAttribute;
+    bool m_Enabled;
+    std::vector<Vertex> m_Vertices;
+    size_t m_ShapeCount;
+    size_t m_DrawCallCount;
+    size_t m_LastFrameShapeCount;
+    size_t m_LastFrameDrawCallCount;
+};
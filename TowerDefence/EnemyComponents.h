@@ -0,0 +1,125 @@
+#pragma once
+#include "structs.h"
+#include <cstdint>
+
+// Every enemy kind is one archetype: a fixed set of components stored in
+// dense, parallel arrays (see EnemyWorld).
+enum class EnemyType {
+    Melee,
+    Ranged,
+    Boss
+};
+
+// Bits used by systems to declare what they read and write, so the scheduler
+// can tell which systems are independent. The last bits are shared resources
+// rather than per-enemy components.
+using ComponentMask = uint32_t;
+
+namespace Component
+{
+    const ComponentMask Transform{ 1u << 0 };
+    const ComponentMask Health{ 1u << 1 };
+    const ComponentMask Movement{ 1u << 2 };
+    const ComponentMask MeleeAttack{ 1u << 3 };
+    const ComponentMask RangedAttack{ 1u << 4 };
+    const ComponentMask BossBurst{ 1u << 5 };
+    const ComponentMask RenderStyle{ 1u << 6 };
+    const ComponentMask EnemyProjectiles{ 1u << 7 };
+    const ComponentMask TowerBullets{ 1u << 8 };
+    const ComponentMask TowerHealth{ 1u << 9 };
+    const ComponentMask TowerTarget{ 1u << 10 };
+    const ComponentMask EnemyGrid{ 1u << 11 };
+    const ComponentMask Steering{ 1u << 12 };
+    const ComponentMask Lod{ 1u << 13 };
+    const ComponentMask Timers{ 1u << 14 };
+    const ComponentMask StatusEffects{ 1u << 15 };
+}
+
+struct TransformComponent
+{
+    Ellipsef shape;
+};
+
+struct HealthComponent
+{
+    float health;
+    float maxHealth;
+};
+
+struct MovementComponent
+{
+    float speed;
+    // Stop walking once the tower is this close (ranged enemies keep their distance)
+    float holdDistance;
+    // Step back at half speed when closer than this (melee enemies)
+    float backOffDistance;
+    // Set by slows; 0 while stunned, which also holds back attacks
+    float speedScale;
+};
+
+// Attack cooldowns live in the timing wheel: an enemy is ready again when its
+// timer fires, nothing counts down in between
+struct MeleeAttackComponent
+{
+    bool ready;
+    bool atTower;
+    int powerLevel;
+    float preferredDistance;
+};
+
+struct RangedAttackComponent
+{
+    float bulletDamage;
+    // The cooldown ran out while out of range, so the next shot goes at once
+    bool ready;
+    float cooldownMax;
+    float attackRange;
+    bool isShooting;
+};
+
+// Burst parameters; the bursts themselves are a script per boss, started on
+// spawn, which keeps where the boss is in its attack
+struct BossBurstComponent
+{
+    float attackSpeed;
+    float bulletDamage;
+    // Volleys and their spacing for patterns that take them from the boss
+    int burstCount;
+    float burstDelay;
+    float preferredDistance;
+    // Picks the bullet patterns the boss has unlocked
+    int powerLevel;
+    // Bursts fired so far, which pattern comes next
+    int burstIndex;
+};
+
+// Index of the tower this enemy walks to and attacks, refreshed every tick
+struct TowerTargetComponent
+{
+    int tower;
+};
+
+// Push away from overlapping neighbours, gathered before any enemy moves
+struct SteeringComponent
+{
+    Vector2f separation;
+};
+
+// Simulation level of detail. Enemies far from every tower only run the
+// per-enemy systems every few ticks, catching up with the time they skipped.
+struct LodComponent
+{
+    // Seconds to simulate when active: one tick near a tower, several far away
+    float elapsed;
+    // Ticks until the next update while far; 0 means near and updated every tick
+    int countdown;
+    bool active;
+    // Last movement per second, so far enemies are drawn moving smoothly
+    Vector2f velocity;
+};
+
+struct RenderStyleComponent
+{
+    Color4f bodyColor;
+    int powerLevel;
+};
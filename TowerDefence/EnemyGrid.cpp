@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "EnemyGrid.h"
+#include "EnemyWorld.h"
+#include <algorithm>
+
+EnemyGrid::EnemyGrid(float cellSize)
+    : m_CellSize{ cellSize }
+    , m_Origin{ 0.f, 0.f }
+    , m_Columns{ 1 }
+    , m_Rows{ 1 }
+    , m_MaxRadius{ 0.f }
+{
+}
+
+void EnemyGrid::Build(const EnemyWorld& enemies, float width, float height)
+{
+    // Enemies spawn just outside the window, so the grid gets a one cell border
+    m_Origin = Vector2f{ -m_CellSize, -m_CellSize };
+    m_Columns = std::max(1, static_cast<int>(width / m_CellSize) + 3);
+    m_Rows = std::max(1, static_cast<int>(height / m_CellSize) + 3);
+    size_t cellCount = static_cast<size_t>(m_Columns) * m_Rows;
+    m_CellStart.assign(cellCount + 1, 0);
+
+    size_t count = enemies.GetCount();
+    m_EntryCells.resize(count);
+    m_Entries.resize(count);
+
+    // Count per cell, then prefix sum, then scatter in world order
+    size_t index = 0;
+    for (int i = 0; i < EnemyWorld::ArchetypeCount; ++i)
+    {
+        for (const TransformComponent& transform : enemies.GetArchetypes()[i].transforms)
+        {
+            const Vector2f& position = transform.shape.center;
+            uint32_t cell = static_cast<uint32_t>(GetRow(position.y) * m_Columns + GetColumn(position.x));
+            m_EntryCells[index++] = cell;
+            ++m_CellStart[cell + 1];
+        }
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell)
+        m_CellStart[cell + 1] += m_CellStart[cell];
+
+    m_CellFill.assign(m_CellStart.begin(), m_CellStart.end() - 1);
+    m_MaxRadius = 0.f;
+    index = 0;
+    for (int i = 0; i < EnemyWorld::ArchetypeCount; ++i)
+    {
+        const EnemyArchetype& archetype = enemies.GetArchetypes()[i];
+        for (size_t row = 0; row < archetype.Size(); ++row)
+        {
+            uint32_t slot = m_CellFill[m_EntryCells[index++]]++;
+            const Ellipsef& shape = archetype.transforms[row].shape;
+            m_Entries[slot] = Entry{ shape.center, shape.radiusX, archetype.type, static_cast<uint32_t>(row) };
+            m_MaxRadius = std::max(m_MaxRadius, shape.radiusX);
+        }
+    }
+}
+
+void EnemyGrid::QueryInto(const Vector2f& center, float radius, std::vector<uint32_t>& out) const
+{
+    out.clear();
+    if (m_Entries.empty()) return;
+    const float reach = radius + m_MaxRadius;
+    int minX = GetColumn(center.x - reach);
+    int maxX = GetColumn(center.x + reach);
+    int minY = GetRow(center.y - reach);
+    int maxY = GetRow(center.y + reach);
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            int cell = y * m_Columns + x;
+            for (uint32_t i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i)
+            {
+                const Entry& entry = m_Entries[i];
+                float dx = entry.position.x - center.x;
+                float dy = entry.position.y - center.y;
+                float touch = radius + entry.radius;
+                if (dx * dx + dy * dy <= touch * touch)
+                    out.push_back(i);
+            }
+        }
+    }
+}
+
+int EnemyGrid::GetColumn(float x) const
+{
+    int column = static_cast<int>((x - m_Origin.x) / m_CellSize);
+    return std::min(std::max(column, 0), m_Columns - 1);
+}
+
+int EnemyGrid::GetRow(float y) const
+{
+    int row = static_cast<int>((y - m_Origin.y) / m_CellSize);
+    return std::min(std::max(row, 0), m_Rows - 1);
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "structs.h"
+#include "EnemyComponents.h"
+#include <vector>
+#include <cstdint>
+
+class EnemyWorld;
+
+// Uniform grid over the play field, rebuilt from the enemy transforms once per
+// tick (a counting sort, no allocations after warm-up) and shared by every
+// tower and system that needs "enemies near a point". Rows are only valid
+// until the world changes structurally, i.e. until RemoveDead.
+class EnemyGrid
+{
+public:
+    struct Entry
+    {
+        Vector2f position;
+        float radius;
+        EnemyType type;
+        uint32_t row;
+    };
+
+    explicit EnemyGrid(float cellSize = 32.f);
+
+    void Build(const EnemyWorld& enemies, float width, float height);
+
+    // Calls visit(entry) for every enemy in the cells overlapping the circle,
+    // in a fixed order; the caller does the exact distance test
+    template <typename Visitor>
+    void Query(const Vector2f& center, float radius, Visitor visit) const
+    {
+        if (m_Entries.empty()) return;
+        int minX = GetColumn(center.x - radius);
+        int maxX = GetColumn(center.x + radius);
+        int minY = GetRow(center.y - radius);
+        int maxY = GetRow(center.y + radius);
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                int cell = y * m_Columns + x;
+                for (uint32_t i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i)
+                    visit(m_Entries[i]);
+            }
+        }
+    }
+
+    // Like Query, but stops as soon as visit returns false. The cell holding
+    // the centre comes first, so a capped search in a crowd still sees the
+    // closest enemies rather than one corner of the area.
+    template <typename Visitor>
+    void QueryUntil(const Vector2f& center, float radius, Visitor visit) const
+    {
+        if (m_Entries.empty()) return;
+        int centerCell = GetRow(center.y) * m_Columns + GetColumn(center.x);
+        for (uint32_t i = m_CellStart[centerCell]; i < m_CellStart[centerCell + 1]; ++i)
+            if (!visit(m_Entries[i])) return;
+
+        int minX = GetColumn(center.x - radius);
+        int maxX = GetColumn(center.x + radius);
+        int minY = GetRow(center.y - radius);
+        int maxY = GetRow(center.y + radius);
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                int cell = y * m_Columns + x;
+                if (cell == centerCell) continue;
+                for (uint32_t i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i)
+                    if (!visit(m_Entries[i])) return;
+            }
+        }
+    }
+
+    // Indices into GetEntries() of every enemy whose circle touches the given
+    // one, in the same fixed order as Query. out is cleared first but keeps its
+    // capacity, so a caller that reuses one buffer stops allocating after the
+    // first big crowd.
+    void QueryInto(const Vector2f& center, float radius, std::vector<uint32_t>& out) const;
+
+    float GetCellSize() const { return m_CellSize; }
+    size_t GetCount() const { return m_Entries.size(); }
+    // Entries in cell order, for passes that walk every enemy near its neighbours
+    const std::vector<Entry>& GetEntries() const { return m_Entries; }
+
+private:
+    int GetColumn(float x) const;
+    int GetRow(float y) const;
+
+    float m_CellSize;
+    Vector2f m_Origin;
+    int m_Columns;
+    int m_Rows;
+    // Largest entry radius of the last Build, so QueryInto reaches every cell
+    // an overlapping enemy can sit in
+    float m_MaxRadius;
+    std::vector<uint32_t> m_CellStart;
+    std::vector<uint32_t> m_EntryCells;
+    std::vector<uint32_t> m_CellFill;
+    std::vector<Entry> m_Entries;
+};
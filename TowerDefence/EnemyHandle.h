@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+// Stable 32-bit reference to one enemy: the low bits index a slot in the
+// EnemyWorld, the high bits hold that slot's generation. A slot's generation
+// is bumped whenever its enemy is removed, so a stale handle never resolves to
+// whichever enemy reuses the slot, and checking validity is a single compare.
+struct EnemyHandle
+{
+    static const uint32_t IndexBits{ 20 };
+    static const uint32_t IndexMask{ (1u << IndexBits) - 1 };
+    static const uint32_t GenerationMask{ (1u << (32 - IndexBits)) - 1 };
+
+    // Generation 0 is never handed out, so a zero value is always invalid
+    uint32_t value{ 0 };
+
+    EnemyHandle() = default;
+    EnemyHandle(uint32_t index, uint32_t generation)
+        : value{ (generation << IndexBits) | (index & IndexMask) }
+    {
+    }
+
+    uint32_t GetIndex() const { return value & IndexMask; }
+    uint32_t GetGeneration() const { return value >> IndexBits; }
+    bool IsNull() const { return value == 0; }
+
+    bool operator==(const EnemyHandle& other) const { return value == other.value; }
+    bool operator!=(const EnemyHandle& other) const { return value != other.value; }
+};
@@ -0,0 +1,750 @@
+#include "pch.h"
+#include "EnemySystems.h"
+#include "EnemyWorld.h"
+#include "SystemScheduler.h"
+#include "EnemyGrid.h"
+#include "AreaDamage.h"
+#include "ParticleSystem.h"
+#include "TowerIndex.h"
+#include "FlowField.h"
+#include "TimingWheel.h"
+#include "ScriptRuntime.h"
+#include "ProjectileStore.h"
+#include "StatusEffects.h"
+#include "BulletPattern.h"
+#include "Tower.h"
+#include "Bullet.h"
+#include "Random.h"
+#include "CircleRenderer.h"
+#include "utils.h"
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Largest enemy radius (bosses), so grid queries reach every enemy that can overlap
+    const float g_MaxEnemyRadius{ 30.f };
+    // Only the first few overlapping neighbours push, and only so many
+    // candidates are looked at, so a packed crowd at the tower costs the same
+    // per enemy as a sparse one
+    const int g_MaxSeparationNeighbours{ 6 };
+    const int g_MaxSeparationCandidates{ 24 };
+    // Enemies this far beyond a tower's range (and every enemy's attack
+    // range) only update every g_DistantInterval ticks
+    const float g_DistantDistance{ 400.f };
+    const float g_DistantRangeMargin{ 100.f };
+    const int g_DistantInterval{ 4 };
+    // Area upgrades: splash deals this share of the shot's damage, explosions
+    // reach this far, and lightning jumps this far losing this much per jump
+    const float g_SplashFraction{ 0.5f };
+    const float g_ExplosionRadius{ 48.f };
+    const float g_ChainRange{ 90.f };
+    const float g_ChainFalloff{ 0.7f };
+    // Status upgrades: how long each effect lasts, the strongest slow and how
+    // many poison applications stack
+    const float g_SlowDuration{ 2.f };
+    const float g_MaxSlow{ 0.75f };
+    const float g_BurnDuration{ 3.f };
+    const float g_PoisonDuration{ 5.f };
+    const float g_MaxPoisonStacks{ 5.f };
+    const float g_StunDuration{ 0.6f };
+
+    // Steps of the boss burst script, kept in ScriptFrame::step
+    enum BossStep
+    {
+        BossApproach,
+        BossStartBurst,
+        BossShot
+    };
+
+    float DistanceTo(const Vector2f& from, const Vector2f& to)
+    {
+        float dx = to.x - from.x;
+        float dy = to.y - from.y;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    // Queues the splash, explosion and chain lightning of a tower's shot that
+    // hit target at point
+    void AddAreaHits(const Tower& tower, const EnemyWorld& world, const EnemyGrid& grid, AreaDamage& area,
+        const Vector2f& point, EnemyHandle target, float damage)
+    {
+        area.AddBlast(world, grid, point, tower.GetSplashRadius(), damage * g_SplashFraction, target);
+        area.AddBlast(world, grid, point, g_ExplosionRadius, tower.GetExplosiveDamage(), EnemyHandle{});
+        area.AddChain(world, grid, point, target, tower.GetChainJumps(), g_ChainRange, damage, g_ChainFalloff);
+    }
+
+    // Puts the status effects of a tower's shot on the enemy it hit
+    void ApplyStatusEffects(const Tower& tower, StatusEffects& status, EnemyHandle target, EnemyType type)
+    {
+        if (tower.GetSlowAmount() > 0.f)
+            status.Apply(StatusType::Slow, target, g_SlowDuration, std::min(tower.GetSlowAmount(), g_MaxSlow));
+        if (tower.GetBurnDamage() > 0.f)
+            status.Apply(StatusType::Burn, target, g_BurnDuration, tower.GetBurnDamage());
+        if (tower.GetPoisonDamage() > 0.f)
+            status.Apply(StatusType::Poison, target, g_PoisonDuration, tower.GetPoisonDamage(), tower.GetPoisonDamage() * g_MaxPoisonStacks);
+        if (tower.GetStunChance() > 0.f && type != EnemyType::Boss && Random::NextFloat() < tower.GetStunChance())
+            status.Apply(StatusType::Stun, target, g_StunDuration, 1.f);
+    }
+
+    bool IsStunned(const EnemyArchetype& archetype, size_t row)
+    {
+        return archetype.movements[row].speedScale <= 0.f;
+    }
+
+    // Row of the enemy a timer belongs to, false once that enemy is gone
+    bool LocateTimerTarget(const EnemyWorld& world, const Timer& timer, size_t& row)
+    {
+        EnemyHandle handle;
+        handle.value = timer.target;
+        EnemyType type;
+        return world.Locate(handle, type, row);
+    }
+
+    void DrawHealthBar(const Ellipsef& shape, const HealthComponent& health)
+    {
+        const float healthBarWidth = 30.0f;
+        const float healthBarHeight = 5.0f;
+        const float healthBarY = shape.center.y + shape.radiusY + 5.0f;
+        const float healthBarX = shape.center.x - healthBarWidth / 2.0f;
+
+        utils::SetColor(Color4f(0.3f, 0.3f, 0.3f, 0.7f));
+        utils::FillRect(healthBarX, healthBarY, healthBarWidth, healthBarHeight);
+
+        float healthPercentage = health.health / health.maxHealth;
+        utils::SetColor(Color4f(0.2f, 0.8f, 0.2f, 0.7f));
+        utils::FillRect(healthBarX, healthBarY, healthBarWidth * healthPercentage, healthBarHeight);
+    }
+
+    void DrawMelee(const EnemyArchetype& melee, CircleRenderer& circles)
+    {
+        for (size_t row = 0; row < melee.Size(); ++row)
+        {
+            const Ellipsef shape = EnemySystems::GetDrawShape(melee, row);
+            const RenderStyleComponent& style = melee.renderStyles[row];
+            circles.Fill(shape, style.bodyColor);
+
+            if (style.powerLevel > 1) {
+                float pulseIntensity = 0.6f + 0.2f * sin(SDL_GetTicks() * 0.005f);
+                Color4f powerColor;
+                switch (style.powerLevel) {
+                case 2:
+                    powerColor = Color4f(1.0f, 0.7f, 0.0f, pulseIntensity);
+                    break;
+                case 3:
+                    powerColor = Color4f(1.0f, 0.4f, 0.0f, pulseIntensity);
+                    break;
+                default:
+                    powerColor = Color4f(1.0f, 0.0f, 0.0f, pulseIntensity);
+                    break;
+                }
+                circles.Fill(shape.center, shape.radiusX * 1.2f, shape.radiusY * 1.2f, powerColor);
+                circles.Fill(shape, Color4f(1.f, 0.2f, 0.3f, 1.f));
+            }
+        }
+        // Health bars go over all the bodies
+        circles.Flush();
+        for (size_t row = 0; row < melee.Size(); ++row)
+            DrawHealthBar(EnemySystems::GetDrawShape(melee, row), melee.healths[row]);
+    }
+
+    void DrawRanged(const EnemyArchetype& ranged, CircleRenderer& circles)
+    {
+        for (size_t row = 0; row < ranged.Size(); ++row)
+        {
+            const Ellipsef shape = EnemySystems::GetDrawShape(ranged, row);
+            const RangedAttackComponent& attack = ranged.rangedAttacks[row];
+            circles.Fill(shape, ranged.renderStyles[row].bodyColor);
+
+            if (attack.isShooting)
+                circles.Fill(shape.center, shape.radiusX * 1.2f, shape.radiusY * 1.2f, Color4f(1.0f, 0.0f, 0.0f, 0.7f));
+
+            circles.Fill(shape.center, attack.attackRange, attack.attackRange, Color4f(0.7f, 0.3f, 0.9f, 0.15f));
+            circles.Outline(shape.center, attack.attackRange, attack.attackRange, Color4f(0.8f, 0.2f, 1.0f, 0.3f), 1.0f);
+        }
+        circles.Flush();
+        for (size_t row = 0; row < ranged.Size(); ++row)
+            DrawHealthBar(EnemySystems::GetDrawShape(ranged, row), ranged.healths[row]);
+    }
+
+    // Crown points of a boss: the base corners, then the tips and dips between
+    void GetCrown(const Ellipsef& shape, Vector2f points[7], float& crownBaseY, float& crownTopY, float& crownWidth)
+    {
+        crownBaseY = shape.center.y + shape.radiusY * 0.8f;
+        crownTopY = shape.center.y + shape.radiusY * 1.5f;
+        crownWidth = shape.radiusX * 1.5f;
+
+        points[0] = Vector2f(shape.center.x - crownWidth / 2, crownBaseY);
+        points[1] = Vector2f(shape.center.x - crownWidth / 3, crownTopY);
+        points[2] = Vector2f(shape.center.x - crownWidth / 6, crownBaseY + (crownTopY - crownBaseY) * 0.6f);
+        points[3] = Vector2f(shape.center.x, crownTopY);
+        points[4] = Vector2f(shape.center.x + crownWidth / 6, crownBaseY + (crownTopY - crownBaseY) * 0.6f);
+        points[5] = Vector2f(shape.center.x + crownWidth / 3, crownTopY);
+        points[6] = Vector2f(shape.center.x + crownWidth / 2, crownBaseY);
+    }
+
+    // Bodies and glows of all bosses go out in one batch, then the crown
+    // lines, then the gems on top of them in a second batch
+    void DrawBoss(const EnemyArchetype& boss, CircleRenderer& circles)
+    {
+        for (size_t row = 0; row < boss.Size(); ++row)
+        {
+            const Ellipsef shape = EnemySystems::GetDrawShape(boss, row);
+            const RenderStyleComponent& style = boss.renderStyles[row];
+            const int powerLevel = style.powerLevel;
+
+            circles.Fill(shape, style.bodyColor);
+
+            if (powerLevel > 1) {
+                float hue = (powerLevel - 1) * 0.1f;
+                circles.Fill(shape.center, shape.radiusX * 1.2f, shape.radiusY * 1.2f,
+                    Color4f(1.0f - hue, 0.2f + hue, 0.8f - hue * 0.5f, 0.3f));
+
+                if (powerLevel > 2) {
+                    float pulseSize = 1.4f + 0.1f * std::sin(SDL_GetTicks() * 0.005f);
+                    circles.Fill(shape.center, shape.radiusX * pulseSize, shape.radiusY * pulseSize,
+                        Color4f(1.0f - hue, 0.2f, 0.5f, 0.15f));
+                }
+            }
+        }
+        circles.Flush();
+
+        utils::SetColor(Color4f(1.f, 0.8f, 0.f, 1.f));
+        for (size_t row = 0; row < boss.Size(); ++row)
+        {
+            Vector2f points[7];
+            float crownBaseY, crownTopY, crownWidth;
+            GetCrown(EnemySystems::GetDrawShape(boss, row), points, crownBaseY, crownTopY, crownWidth);
+            for (int i = 0; i < 7; ++i)
+                utils::DrawLine(points[i], points[(i + 1) % 7]);
+        }
+
+        for (size_t row = 0; row < boss.Size(); ++row)
+        {
+            const int powerLevel = boss.renderStyles[row].powerLevel;
+            if (powerLevel <= 1) continue;
+            const Ellipsef shape = EnemySystems::GetDrawShape(boss, row);
+            Vector2f points[7];
+            float crownBaseY, crownTopY, crownWidth;
+            GetCrown(shape, points, crownBaseY, crownTopY, crownWidth);
+            for (int i = 0; i < std::min(powerLevel - 1, 3); i++) {
+                float gemX = shape.center.x + (i - 1) * (crownWidth / 6);
+                float gemY = crownBaseY + (crownTopY - crownBaseY) * 0.85f;
+                float gemSize = shape.radiusX * 0.15f;
+
+                Color4f gemColor;
+                switch (i % 3) {
+                case 0: gemColor = Color4f(1.0f, 0.2f, 0.2f, 1.0f); break;
+                case 1: gemColor = Color4f(0.2f, 1.0f, 0.2f, 1.0f); break;
+                case 2: gemColor = Color4f(0.2f, 0.2f, 1.0f, 1.0f); break;
+                }
+
+                circles.Fill(Vector2f(gemX, gemY), gemSize, gemSize, gemColor);
+            }
+        }
+        circles.Flush();
+
+        for (size_t row = 0; row < boss.Size(); ++row)
+        {
+            const Ellipsef shape = EnemySystems::GetDrawShape(boss, row);
+            const HealthComponent& health = boss.healths[row];
+            float barWidth = shape.radiusX * 2.0f;
+            float barHeight = 6.0f;
+            float barX = shape.center.x - barWidth / 2.0f;
+            float barY = shape.center.y - shape.radiusY - 14.0f;
+            float healthRatio = health.health / health.maxHealth;
+
+            utils::SetColor(Color4f(0.2f, 0.2f, 0.2f, 0.8f));
+            utils::FillRect(barX, barY, barWidth, barHeight);
+            utils::SetColor(Color4f(0.9f, 0.1f, 0.1f, 0.9f));
+            utils::FillRect(barX, barY, barWidth * healthRatio, barHeight);
+            utils::SetColor(Color4f(0.f, 0.f, 0.f, 1.f));
+            utils::DrawRect(barX, barY, barWidth, barHeight, 1.0f);
+        }
+    }
+}
+
+void EnemySystems::Register(SystemScheduler& scheduler)
+{
+    // Runs first so damage over time kills and speed scales apply this tick
+    scheduler.AddSystem("Status", 0, Component::StatusEffects | Component::Health | Component::Movement, &EnemySystems::Status);
+    scheduler.AddSystem("AssignTowers", Component::Transform, Component::TowerTarget | Component::Lod, &EnemySystems::AssignTowers);
+    scheduler.AddSystem("Movement", Component::Movement | Component::TowerTarget, Component::Transform | Component::Lod, &EnemySystems::Movement);
+    scheduler.AddSystem("BuildGrid", Component::Transform, Component::EnemyGrid, &EnemySystems::BuildGrid);
+    scheduler.AddSystem("Separation", Component::Movement | Component::EnemyGrid | Component::Lod, Component::Transform | Component::Steering, &EnemySystems::Separation);
+    scheduler.AddSystem("TowerBulletHits", Component::Transform | Component::EnemyGrid, Component::Health | Component::TowerBullets | Component::StatusEffects, &EnemySystems::TowerBulletHits);
+    // Enemies killed by the tower this tick no longer attack
+    scheduler.AddSystem("MeleeAttack", Component::Transform | Component::Health | Component::Movement | Component::TowerTarget | Component::Lod, Component::MeleeAttack | Component::TowerHealth | Component::Timers, &EnemySystems::MeleeAttack);
+    scheduler.AddSystem("RangedAttack", Component::Transform | Component::Health | Component::Movement | Component::TowerTarget | Component::Lod, Component::RangedAttack | Component::EnemyProjectiles | Component::Timers, &EnemySystems::RangedAttack);
+    scheduler.AddSystem("BossBurst", Component::Transform | Component::Health | Component::TowerTarget | Component::Lod, Component::BossBurst | Component::EnemyProjectiles | Component::Timers, &EnemySystems::BossBurst);
+    scheduler.AddSystem("Projectiles", 0, Component::EnemyProjectiles | Component::TowerHealth, &EnemySystems::Projectiles);
+}
+
+void EnemySystems::Status(EnemyWorld& world, SimulationContext& context)
+{
+    world.GetStatusEffects().Update(world, context.elapsedSec);
+}
+
+void EnemySystems::AssignTowers(EnemyWorld& world, SimulationContext& context)
+{
+    // Also sorts enemies into level of detail groups: anything near a tower
+    // updates every tick, distant enemies every few ticks with the time they
+    // skipped. The check is redone on each update, so an enemy walking into
+    // range joins the near group within one interval.
+    const std::vector<Tower*>& towers = *context.pTowers;
+    for (int i = 0; i < EnemyWorld::ArchetypeCount; ++i)
+    {
+        EnemyArchetype& archetype = world.GetArchetypes()[i];
+        for (size_t row = 0; row < archetype.Size(); ++row)
+        {
+            LodComponent& lod = archetype.lods[row];
+            if (lod.active) lod.elapsed = 0.f;
+            lod.elapsed += context.elapsedSec;
+            if (lod.countdown > 1 && !context.towersChanged)
+            {
+                --lod.countdown;
+                lod.active = false;
+                ++context.distantCount;
+                continue;
+            }
+
+            const Vector2f& center = archetype.transforms[row].shape.center;
+            int tower = context.pTowerIndex->FindNearest(center);
+            tower = tower >= 0 ? tower : 0;
+            archetype.towerTargets[row].tower = tower;
+            lod.active = true;
+
+            float distantDistance = std::max(g_DistantDistance, towers[tower]->GetRange() + g_DistantRangeMargin);
+            Vector2f target = towers[tower]->GetCenter();
+            float dx = target.x - center.x;
+            float dy = target.y - center.y;
+            if (dx * dx + dy * dy > distantDistance * distantDistance)
+            {
+                // Spread newly distant enemies over the interval so the
+                // updates do not all land on the same tick
+                lod.countdown = lod.countdown == 0
+                    ? 1 + static_cast<int>(archetype.handles[row].GetIndex() % g_DistantInterval)
+                    : g_DistantInterval;
+                ++context.distantCount;
+                ++context.distantUpdatedCount;
+            }
+            else
+            {
+                lod.countdown = 0;
+                ++context.nearCount;
+            }
+        }
+    }
+}
+
+void EnemySystems::Movement(EnemyWorld& world, SimulationContext& context)
+{
+    const std::vector<Tower*>& towers = *context.pTowers;
+    const float approachMargin = context.pFlowField->GetCellSize() * 2.f;
+    for (int i = 0; i < EnemyWorld::ArchetypeCount; ++i)
+    {
+        EnemyArchetype& archetype = world.GetArchetypes()[i];
+        for (size_t row = 0; row < archetype.Size(); ++row)
+        {
+            LodComponent& lod = archetype.lods[row];
+            if (!lod.active) continue;
+            Vector2f& center = archetype.transforms[row].shape.center;
+            const MovementComponent& movement = archetype.movements[row];
+            const Vector2f target = towers[archetype.towerTargets[row].tower]->GetCenter();
+            const float speed = movement.speed * movement.speedScale;
+            float moveDistance = speed * lod.elapsed;
+
+            // Far from the tower, walk down the flow field: no sqrt or divide
+            // unless the blended direction needs renormalising
+            float dx = target.x - center.x;
+            float dy = target.y - center.y;
+            float approachDistance = movement.holdDistance + approachMargin;
+            if (dx * dx + dy * dy > approachDistance * approachDistance)
+            {
+                Vector2f direction = context.pFlowField->Sample(center);
+                float lengthSq = direction.x * direction.x + direction.y * direction.y;
+                if (lengthSq > 0.0001f)
+                {
+                    float step = lengthSq < 0.81f ? moveDistance / std::sqrt(lengthSq) : moveDistance;
+                    center.x += direction.x * step;
+                    center.y += direction.y * step;
+                    lod.velocity = lod.countdown > 0
+                        ? Vector2f{ direction.x * step / lod.elapsed, direction.y * step / lod.elapsed }
+                        : Vector2f{ 0.f, 0.f };
+                    continue;
+                }
+            }
+
+            // Final approach is straight at the tower, where the field is too coarse
+            lod.velocity = Vector2f{ 0.f, 0.f };
+            float distance = DistanceTo(center, target);
+            if (distance <= movement.holdDistance || distance < 1.0f) continue;
+
+            if (moveDistance > distance)
+            {
+                center = target;
+            }
+            else
+            {
+                center.x += (target.x - center.x) / distance * moveDistance;
+                center.y += (target.y - center.y) / distance * moveDistance;
+            }
+
+            if (movement.backOffDistance > 0.f)
+            {
+                distance = DistanceTo(center, target);
+                if (distance <= movement.backOffDistance - 0.5f && distance > 0.1f)
+                {
+                    float backOff = speed * 0.5f * lod.elapsed;
+                    center.x -= (target.x - center.x) / distance * backOff;
+                    center.y -= (target.y - center.y) / distance * backOff;
+                }
+            }
+        }
+    }
+}
+
+void EnemySystems::BuildGrid(EnemyWorld& world, SimulationContext& context)
+{
+    context.pEnemyGrid->Build(world, context.windowWidth, context.windowHeight);
+}
+
+void EnemySystems::Separation(EnemyWorld& world, SimulationContext& context)
+{
+    // Gather every push from the grid's copy of the positions first, so the
+    // result does not depend on the order enemies are visited in
+    const EnemyGrid& grid = *context.pEnemyGrid;
+    for (const EnemyGrid::Entry& self : grid.GetEntries())
+    {
+        // Enemies waiting for their next update still push their neighbours
+        if (!world.GetArchetype(self.type).lods[self.row].active) continue;
+        Vector2f push{ 0.f, 0.f };
+        int neighbours = 0;
+        int candidates = 0;
+        grid.QueryUntil(self.position, self.radius + g_MaxEnemyRadius, [&](const EnemyGrid::Entry& other) {
+            if (other.type == self.type && other.row == self.row) return true;
+            if (++candidates > g_MaxSeparationCandidates) return false;
+            float dx = self.position.x - other.position.x;
+            float dy = self.position.y - other.position.y;
+            float minDistance = self.radius + other.radius;
+            float distanceSq = dx * dx + dy * dy;
+            if (distanceSq >= minDistance * minDistance) return true;
+
+            if (distanceSq > 0.0001f)
+            {
+                // Each of the pair moves back half the overlap
+                float distance = std::sqrt(distanceSq);
+                float scale = (minDistance - distance) * 0.5f / distance;
+                push.x += dx * scale;
+                push.y += dy * scale;
+            }
+            else
+            {
+                // Exactly on top of each other: split along x in a fixed order
+                bool first = self.type < other.type || (self.type == other.type && self.row < other.row);
+                push.x += first ? -minDistance * 0.5f : minDistance * 0.5f;
+            }
+            return ++neighbours < g_MaxSeparationNeighbours;
+        });
+        world.GetArchetype(self.type).steerings[self.row].separation = push;
+    }
+
+    // Never push faster than the enemy walks, so crowds spread out smoothly
+    for (int i = 0; i < EnemyWorld::ArchetypeCount; ++i)
+    {
+        EnemyArchetype& archetype = world.GetArchetypes()[i];
+        for (size_t row = 0; row < archetype.Size(); ++row)
+        {
+            const LodComponent& lod = archetype.lods[row];
+            if (!lod.active) continue;
+            const Vector2f& push = archetype.steerings[row].separation;
+            float lengthSq = push.x * push.x + push.y * push.y;
+            if (lengthSq == 0.f) continue;
+            float maxStep = archetype.movements[row].speed * lod.elapsed;
+            float scale = lengthSq > maxStep * maxStep ? maxStep / std::sqrt(lengthSq) : 1.f;
+            Vector2f& center = archetype.transforms[row].shape.center;
+            center.x += push.x * scale;
+            center.y += push.y * scale;
+        }
+    }
+}
+
+void EnemySystems::MeleeAttack(EnemyWorld& world, SimulationContext& context)
+{
+    EnemyArchetype& melee = world.GetArchetype(EnemyType::Melee);
+    size_t timerRow = 0;
+    for (const Timer& timer : *context.pDueTimers)
+    {
+        if (timer.kind == TimerKind::MeleeReady && LocateTimerTarget(world, timer, timerRow))
+            melee.meleeAttacks[timerRow].ready = true;
+    }
+
+    const uint32_t cooldownTicks = TimingWheel::ToTicks(1.0f, context.elapsedSec);
+    for (size_t row = 0; row < melee.Size(); ++row)
+    {
+        const LodComponent& lod = melee.lods[row];
+        if (melee.healths[row].health <= 0.f || !lod.active) continue;
+        MeleeAttackComponent& attack = melee.meleeAttacks[row];
+
+        int tower = melee.towerTargets[row].tower;
+        float distance = DistanceTo(melee.transforms[row].shape.center, (*context.pTowers)[tower]->GetCenter());
+        attack.atTower = (distance <= attack.preferredDistance + 5.0f);
+        if (attack.atTower && attack.ready && !IsStunned(melee, row))
+        {
+            (*context.pTowerDamage)[tower] += attack.powerLevel;
+            attack.ready = false;
+            context.pTimers->ScheduleIn(cooldownTicks, TimerKind::MeleeReady, melee.handles[row].value);
+        }
+    }
+}
+
+void EnemySystems::RangedAttack(EnemyWorld& world, SimulationContext& context)
+{
+    const float bulletSpeed = 300.0f;
+    EnemyArchetype& ranged = world.GetArchetype(EnemyType::Ranged);
+    ProjectileStore& projectiles = world.GetProjectiles();
+    auto shoot = [&](size_t row, int shots) {
+        RangedAttackComponent& attack = ranged.rangedAttacks[row];
+        const Vector2f& center = ranged.transforms[row].shape.center;
+        const Vector2f target = (*context.pTowers)[ranged.towerTargets[row].tower]->GetCenter();
+        for (int i = 0; i < shots; ++i)
+            projectiles.EmitTowards(center, target, bulletSpeed, static_cast<int>(attack.bulletDamage));
+        attack.isShooting = true;
+        attack.ready = false;
+        context.pTimers->ScheduleIn(TimingWheel::ToTicks(attack.cooldownMax, context.elapsedSec),
+            TimerKind::RangedReady, ranged.handles[row].value);
+    };
+    auto distanceToTower = [&](size_t row) {
+        return DistanceTo(ranged.transforms[row].shape.center, (*context.pTowers)[ranged.towerTargets[row].tower]->GetCenter());
+    };
+
+    // Enemies whose cooldown was already over fire as soon as they reach
+    // range, twice when they are well inside it
+    for (size_t row = 0; row < ranged.Size(); ++row)
+    {
+        const LodComponent& lod = ranged.lods[row];
+        if (ranged.healths[row].health <= 0.f || !lod.active) continue;
+        RangedAttackComponent& attack = ranged.rangedAttacks[row];
+        attack.isShooting = false;
+        if (!attack.ready || IsStunned(ranged, row)) continue;
+
+        float distance = distanceToTower(row);
+        if (distance <= attack.attackRange * 1.05f)
+            shoot(row, distance <= attack.attackRange ? 2 : 1);
+    }
+
+    // Cooldowns running out this tick fire once in range, otherwise wait
+    size_t row = 0;
+    for (const Timer& timer : *context.pDueTimers)
+    {
+        if (timer.kind != TimerKind::RangedReady || !LocateTimerTarget(world, timer, row)) continue;
+        if (ranged.healths[row].health <= 0.f) continue;
+        // Stunned enemies fire once they recover, like those out of range
+        if (!IsStunned(ranged, row) && distanceToTower(row) <= ranged.rangedAttacks[row].attackRange * 1.05f)
+            shoot(row, 1);
+        else
+            ranged.rangedAttacks[row].ready = true;
+    }
+}
+
+void EnemySystems::BossBurst(EnemyWorld& world, SimulationContext& context)
+{
+    EnemyArchetype& boss = world.GetArchetype(EnemyType::Boss);
+    ProjectileStore& projectiles = world.GetProjectiles();
+    context.pScripts->Resume(ScriptType::BossBurst, *context.pDueTimers, [&](ScriptFrame& frame) {
+        EnemyHandle handle;
+        handle.value = frame.target;
+        EnemyType type;
+        size_t row = 0;
+        if (!world.Locate(handle, type, row) || boss.healths[row].health <= 0.f) return ScriptAwait::Done();
+
+        BossBurstComponent& burst = boss.bossBursts[row];
+        const Vector2f target = (*context.pTowers)[boss.towerTargets[row].tower]->GetCenter();
+        const Vector2f& center = boss.transforms[row].shape.center;
+        // Out of range the script waits where it is and carries on once the boss is back
+        if (!boss.lods[row].active || DistanceTo(center, target) > burst.preferredDistance * 1.5f)
+            return ScriptAwait::Condition();
+
+        // The pattern only changes between bursts, so every step of one burst sees the same
+        const BulletPattern& pattern = BulletPatterns::Select(burst.powerLevel, burst.burstIndex);
+        const int volleys = pattern.volleys > 0 ? pattern.volleys : burst.burstCount;
+        const uint32_t cooldownTicks = TimingWheel::ToTicks(1.f / burst.attackSpeed, context.elapsedSec);
+        const uint32_t volleyTicks = TimingWheel::ToTicks(pattern.volleyDelay > 0.f ? pattern.volleyDelay : burst.burstDelay, context.elapsedSec);
+        switch (frame.step)
+        {
+        case BossApproach:
+            // First time in range: the attack cooldown starts now
+            frame.step = BossStartBurst;
+            return ScriptAwait::Delay(cooldownTicks);
+        case BossStartBurst:
+            frame.counter = volleys;
+            frame.step = BossShot;
+            return ScriptAwait::Delay(volleyTicks);
+        default:
+        {
+            float aimAngle = std::atan2(target.y - center.y, target.x - center.x);
+            float bulletSpeed = 250.f + (burst.powerLevel - 1) * 25.f;
+            BulletPatterns::EmitVolley(pattern, burst.powerLevel, volleys - frame.counter, center, aimAngle,
+                bulletSpeed, burst.bulletDamage, projectiles);
+            context.pParticles->Emit(ParticleEffect::BossBurst, center);
+            if (--frame.counter > 0) return ScriptAwait::Delay(volleyTicks);
+            // The attack cooldown starts once the burst is over
+            ++burst.burstIndex;
+            frame.step = BossStartBurst;
+            return ScriptAwait::Delay(cooldownTicks);
+        }
+        }
+    });
+}
+
+void EnemySystems::Projectiles(EnemyWorld& world, SimulationContext& context)
+{
+    ProjectileStore& projectiles = world.GetProjectiles();
+    projectiles.Update(context.elapsedSec, context.windowWidth, context.windowHeight);
+    std::vector<Ellipsef>& towerShapes = *context.pTowerShapes;
+    towerShapes.clear();
+    for (const Tower* tower : *context.pTowers)
+        towerShapes.push_back(tower->GetShape());
+    // Towers never overlap, so a projectile can only hit one of them
+    projectiles.CollectHits(towerShapes, *context.pTowerDamage);
+    projectiles.Compact();
+}
+
+void EnemySystems::TowerBulletHits(EnemyWorld& world, SimulationContext& context)
+{
+    const EnemyGrid& grid = *context.pEnemyGrid;
+    AreaDamage& area = *context.pAreaDamage;
+    area.Begin(grid);
+    StatusEffects& status = world.GetStatusEffects();
+
+    // Shots resolved at fire time land once their flight is over
+    for (Tower* pTower : *context.pTowers)
+    {
+        std::vector<TowerHit>& hits = pTower->GetPendingHits();
+        size_t kept = 0;
+        for (const TowerHit& hit : hits)
+        {
+            if (hit.ticksLeft > 1)
+            {
+                hits[kept] = hit;
+                --hits[kept++].ticksLeft;
+                continue;
+            }
+            EnemyType type;
+            size_t row;
+            if (!world.Locate(hit.target, type, row)) continue;
+            EnemyArchetype& archetype = world.GetArchetype(type);
+            HealthComponent& health = archetype.healths[row];
+            // Killed earlier this tick, by a burn or another tower's hit; like
+            // a simulated bullet, the shot passes through without any effect
+            if (health.health <= 0.f) continue;
+            health.health = std::max(0.f, health.health - hit.damage);
+            ApplyStatusEffects(*pTower, status, hit.target, type);
+            context.pParticles->Emit(ParticleEffect::Impact, archetype.transforms[row].shape.center);
+            AddAreaHits(*pTower, world, grid, area, archetype.transforms[row].shape.center, hit.target, hit.damage);
+        }
+        hits.resize(kept);
+    }
+
+    // Separation has moved enemies up to one walking step since the grid was
+    // built, so the query reaches a little past the largest radius
+    const float hitRadius = g_MaxEnemyRadius + 8.f;
+    for (Tower* pTower : *context.pTowers)
+    {
+        float ricochetRange = pTower->GetRange() * 1.2f;
+        for (Bullet& bullet : pTower->GetBullets())
+        {
+            if (!bullet.IsActive()) continue;
+            // The query covers the whole step the bullet just took, and the
+            // earliest enemy along it is the one hit
+            const Vector2f from = bullet.GetPreviousPosition();
+            const Vector2f to = bullet.GetPosition();
+            const Vector2f middle{ (from.x + to.x) * 0.5f, (from.y + to.y) * 0.5f };
+            const EnemyHandle lastHit = bullet.GetLastHit();
+            const EnemyGrid::Entry* pHit = nullptr;
+            float hitTime = std::numeric_limits<float>::max();
+            grid.Query(middle, hitRadius + DistanceTo(from, to) * 0.5f, [&](const EnemyGrid::Entry& candidate) {
+                const EnemyArchetype& archetype = world.GetArchetype(candidate.type);
+                if (archetype.healths[candidate.row].health <= 0.f || archetype.handles[candidate.row] == lastHit) return;
+                float time = 0.f;
+                if (bullet.CheckSweptHit(archetype.transforms[candidate.row].shape, time) && time < hitTime)
+                {
+                    hitTime = time;
+                    pHit = &candidate;
+                }
+            });
+            if (!pHit) continue;
+
+            const EnemyGrid::Entry& hit = *pHit;
+            EnemyArchetype& archetype = world.GetArchetype(hit.type);
+            HealthComponent& health = archetype.healths[hit.row];
+            health.health = std::max(0.f, health.health - bullet.GetDamage());
+            Vector2f bulletPos{ from.x + (to.x - from.x) * hitTime, from.y + (to.y - from.y) * hitTime };
+            ApplyStatusEffects(*pTower, status, archetype.handles[hit.row], hit.type);
+            context.pParticles->Emit(ParticleEffect::Impact, bulletPos);
+            AddAreaHits(*pTower, world, grid, area, bulletPos, archetype.handles[hit.row], bullet.GetDamage());
+            bullet.TakeDamage();
+            if (!bullet.IsActive() || bullet.GetHP() <= 0)
+            {
+                bullet.Deactivate();
+                continue;
+            }
+
+            // Ricochet from the point of contact towards the nearest other
+            // living enemy in range
+            bullet.MoveTo(bulletPos);
+            bullet.SetLastHit(archetype.handles[hit.row]);
+            const EnemyGrid::Entry* pNext = nullptr;
+            float minDist = std::numeric_limits<float>::max();
+            grid.Query(bulletPos, ricochetRange, [&](const EnemyGrid::Entry& other) {
+                if ((other.type == hit.type && other.row == hit.row) ||
+                    world.GetArchetype(other.type).healths[other.row].health <= 0.f) return;
+                float dist = DistanceTo(bulletPos, other.position);
+                if (dist < minDist && dist <= ricochetRange)
+                {
+                    minDist = dist;
+                    pNext = &other;
+                }
+            });
+            if (pNext)
+            {
+                context.pParticles->Emit(ParticleEffect::Ricochet, bulletPos);
+                bullet.SetTarget(pNext->position.x, pNext->position.y);
+                bullet.SetHomingTarget(world.GetArchetype(pNext->type).handles[pNext->row]);
+            }
+            else
+            {
+                bullet.Deactivate();
+            }
+        }
+    }
+
+    // All area damage of the tick in one pass over the enemies it touched
+    area.Apply(world, grid);
+}
+
+Ellipsef EnemySystems::GetDrawShape(const EnemyArchetype& archetype, size_t row)
+{
+    Ellipsef shape = archetype.transforms[row].shape;
+    const LodComponent& lod = archetype.lods[row];
+    if (!lod.active)
+    {
+        shape.center.x += lod.velocity.x * lod.elapsed;
+        shape.center.y += lod.velocity.y * lod.elapsed;
+    }
+    return shape;
+}
+
+void EnemySystems::Draw(const EnemyWorld& world, CircleRenderer& circles)
+{
+    DrawMelee(world.GetArchetype(EnemyType::Melee), circles);
+    DrawRanged(world.GetArchetype(EnemyType::Ranged), circles);
+    DrawBoss(world.GetArchetype(EnemyType::Boss), circles);
+    world.GetStatusEffects().Draw(world, circles);
+    world.GetProjectiles().Draw();
+}
+
+void EnemySystems::DrawBosses(const EnemyWorld& world, CircleRenderer& circles)
+{
+    DrawBoss(world.GetArchetype(EnemyType::Boss), circles);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+
+class EnemyWorld;
+struct EnemyArchetype;
+class EnemyGrid;
+class AreaDamage;
+class ParticleSystem;
+class Tower;
+class TowerIndex;
+class FlowField;
+class SystemScheduler;
+class TimingWheel;
+class ScriptRuntime;
+class CircleRenderer;
+struct Timer;
+
+// Per-tick input for the enemy systems, plus what they report back to Game
+struct SimulationContext
+{
+    float elapsedSec;
+    // Index 0 is the main tower; the others were placed by the player
+    std::vector<Tower*>* pTowers;
+    const TowerIndex* pTowerIndex;
+    const FlowField* pFlowField;
+    EnemyGrid* pEnemyGrid;
+    // Area hits of tower shots are added up here and applied in one pass
+    AreaDamage* pAreaDamage;
+    // Hit, ricochet and boss burst effects; visual only
+    ParticleSystem* pParticles;
+    // Attack cooldowns are scheduled here; pDueTimers holds this tick's timers
+    TimingWheel* pTimers;
+    const std::vector<Timer>* pDueTimers;
+    // Boss attacks run as scripts resumed by the BossBurst system
+    ScriptRuntime* pScripts;
+    float windowWidth;
+    float windowHeight;
+    // The towers were added to or moved this tick, so every enemy re-checks
+    // its level of detail group
+    bool towersChanged;
+
+    // Damage dealt to each tower this tick, indexed like pTowers
+    std::vector<int>* pTowerDamage;
+    // Scratch for the tower ellipses enemy projectiles collide with, kept by
+    // Game so its capacity survives from tick to tick
+    std::vector<Ellipsef>* pTowerShapes;
+    // Level of detail groups this tick, for the profiler overlay
+    int nearCount;
+    int distantCount;
+    int distantUpdatedCount;
+};
+
+namespace EnemySystems
+{
+    // Registers the simulation systems below with their read/write sets
+    void Register(SystemScheduler& scheduler);
+
+    // Damage over time, slows and stuns, before anything moves or attacks
+    void Status(EnemyWorld& world, SimulationContext& context);
+    void AssignTowers(EnemyWorld& world, SimulationContext& context);
+    void Movement(EnemyWorld& world, SimulationContext& context);
+    void BuildGrid(EnemyWorld& world, SimulationContext& context);
+    void Separation(EnemyWorld& world, SimulationContext& context);
+    void TowerBulletHits(EnemyWorld& world, SimulationContext& context);
+    void MeleeAttack(EnemyWorld& world, SimulationContext& context);
+    void RangedAttack(EnemyWorld& world, SimulationContext& context);
+    void BossBurst(EnemyWorld& world, SimulationContext& context);
+    void Projectiles(EnemyWorld& world, SimulationContext& context);
+
+    // Enemies waiting for their next distant update are drawn where they will
+    // be by then, so they keep moving smoothly between updates
+    Ellipsef GetDrawShape(const EnemyArchetype& archetype, size_t row);
+    // Every enemy in full detail, with status rings and enemy bullets
+    void Draw(const EnemyWorld& world, CircleRenderer& circles);
+    // Only the bosses, for when the rest of the horde is drawn as a swarm
+    void DrawBosses(const EnemyWorld& world, CircleRenderer& circles);
+}
@@ -0,0 +1,423 @@
+#include "pch.h"
+#include "EnemyWorld.h"
+#include "Snapshot.h"
+
+namespace
+{
+    template <typename Component>
+    void SwapAndPop(std::vector<Component>& column, size_t row)
+    {
+        if (column.empty()) return;
+        column[row] = column.back();
+        column.pop_back();
+    }
+
+    void WriteColor(SnapshotWriter& writer, const Color4f& color)
+    {
+        writer.WriteFloat(color.r);
+        writer.WriteFloat(color.g);
+        writer.WriteFloat(color.b);
+        writer.WriteFloat(color.a);
+    }
+
+    Color4f ReadColor(SnapshotReader& reader)
+    {
+        Color4f color;
+        color.r = reader.ReadFloat();
+        color.g = reader.ReadFloat();
+        color.b = reader.ReadFloat();
+        color.a = reader.ReadFloat();
+        return color;
+    }
+}
+
+void EnemyArchetype::Remove(size_t row)
+{
+    SwapAndPop(transforms, row);
+    SwapAndPop(healths, row);
+    SwapAndPop(movements, row);
+    SwapAndPop(meleeAttacks, row);
+    SwapAndPop(rangedAttacks, row);
+    SwapAndPop(bossBursts, row);
+    SwapAndPop(towerTargets, row);
+    SwapAndPop(steerings, row);
+    SwapAndPop(lods, row);
+    SwapAndPop(renderStyles, row);
+    SwapAndPop(handles, row);
+}
+
+void EnemyArchetype::Clear()
+{
+    transforms.clear();
+    healths.clear();
+    movements.clear();
+    meleeAttacks.clear();
+    rangedAttacks.clear();
+    bossBursts.clear();
+    towerTargets.clear();
+    steerings.clear();
+    lods.clear();
+    renderStyles.clear();
+    handles.clear();
+}
+
+EnemyWorld::EnemyWorld()
+{
+    const ComponentMask common{ Component::Transform | Component::Health | Component::Movement | Component::TowerTarget | Component::Steering | Component::Lod | Component::RenderStyle };
+    m_Archetypes[static_cast<int>(EnemyType::Melee)].type = EnemyType::Melee;
+    m_Archetypes[static_cast<int>(EnemyType::Melee)].components = common | Component::MeleeAttack;
+    m_Archetypes[static_cast<int>(EnemyType::Ranged)].type = EnemyType::Ranged;
+    m_Archetypes[static_cast<int>(EnemyType::Ranged)].components = common | Component::RangedAttack;
+    m_Archetypes[static_cast<int>(EnemyType::Boss)].type = EnemyType::Boss;
+    m_Archetypes[static_cast<int>(EnemyType::Boss)].components = common | Component::BossBurst;
+}
+
+size_t EnemyWorld::SpawnMelee(const Ellipsef& shape, int hp, float walkingSpeed)
+{
+    int powerLevel = 1;
+    int baseHp = 1 + (hp / (1 + 0.3f));
+    if (hp > baseHp * 1.5f) {
+        powerLevel = 2;
+    }
+    else if (hp > baseHp * 2.2f) {
+        powerLevel = 3;
+    }
+    else if (hp > baseHp * 3.0f) {
+        powerLevel = 4;
+    }
+
+    EnemyArchetype& melee = GetArchetype(EnemyType::Melee);
+    melee.transforms.push_back(TransformComponent{ shape });
+    melee.healths.push_back(HealthComponent{ float(hp), float(hp) });
+    melee.movements.push_back(MovementComponent{ walkingSpeed, 0.f, 20.f, 1.f });
+    melee.meleeAttacks.push_back(MeleeAttackComponent{ true, false, powerLevel, 20.f });
+    melee.towerTargets.push_back(TowerTargetComponent{ 0 });
+    melee.steerings.push_back(SteeringComponent{ Vector2f{ 0.f, 0.f } });
+    melee.lods.push_back(LodComponent{ 0.f, 0, false, Vector2f{ 0.f, 0.f } });
+    melee.renderStyles.push_back(RenderStyleComponent{ Color4f{ 1.f, 0.f, 0.2f, 1.f }, powerLevel });
+    melee.handles.push_back(AllocateHandle(EnemyType::Melee, melee.Size() - 1));
+    return melee.Size() - 1;
+}
+
+size_t EnemyWorld::SpawnRanged(const Ellipsef& shape, float hp, float walkingSpeed)
+{
+    const float attackRange{ 150.f };
+    float health = float(static_cast<int>(hp));
+
+    EnemyArchetype& ranged = GetArchetype(EnemyType::Ranged);
+    ranged.transforms.push_back(TransformComponent{ shape });
+    ranged.healths.push_back(HealthComponent{ health, health });
+    ranged.movements.push_back(MovementComponent{ walkingSpeed, attackRange, 0.f, 1.f });
+    ranged.rangedAttacks.push_back(RangedAttackComponent{ 1.f, true, 1.5f, attackRange, false });
+    ranged.towerTargets.push_back(TowerTargetComponent{ 0 });
+    ranged.steerings.push_back(SteeringComponent{ Vector2f{ 0.f, 0.f } });
+    ranged.lods.push_back(LodComponent{ 0.f, 0, false, Vector2f{ 0.f, 0.f } });
+    ranged.renderStyles.push_back(RenderStyleComponent{ Color4f{ 0.8f, 0.2f, 0.8f, 1.f }, 1 });
+    ranged.handles.push_back(AllocateHandle(EnemyType::Ranged, ranged.Size() - 1));
+    return ranged.Size() - 1;
+}
+
+size_t EnemyWorld::SpawnBoss(const Ellipsef& shape, int hp, float walkingSpeed, int waveNumber)
+{
+    BossBurstComponent burst{};
+    burst.attackSpeed = 0.5f;
+    burst.powerLevel = 1 + (waveNumber / 5);
+    burst.bulletDamage = 2.f * (1.0f + (burst.powerLevel - 1) * 0.5f);
+    burst.burstCount = 3 + (waveNumber / 10) + (burst.powerLevel - 1);
+    burst.burstDelay = std::max(0.1f, 0.2f - (burst.powerLevel - 1) * 0.02f);
+    burst.preferredDistance = 100.f;
+    burst.burstIndex = 0;
+
+    EnemyArchetype& boss = GetArchetype(EnemyType::Boss);
+    boss.transforms.push_back(TransformComponent{ shape });
+    boss.healths.push_back(HealthComponent{ float(hp), float(hp) });
+    boss.movements.push_back(MovementComponent{ walkingSpeed, 0.f, 0.f, 1.f });
+    boss.bossBursts.push_back(burst);
+    boss.towerTargets.push_back(TowerTargetComponent{ 0 });
+    boss.steerings.push_back(SteeringComponent{ Vector2f{ 0.f, 0.f } });
+    boss.lods.push_back(LodComponent{ 0.f, 0, false, Vector2f{ 0.f, 0.f } });
+    boss.renderStyles.push_back(RenderStyleComponent{ Color4f{ 0.8f, 0.2f, 0.8f, 1.f }, burst.powerLevel });
+    boss.handles.push_back(AllocateHandle(EnemyType::Boss, boss.Size() - 1));
+    return boss.Size() - 1;
+}
+
+EnemyArchetype& EnemyWorld::GetArchetype(EnemyType type)
+{
+    return m_Archetypes[static_cast<int>(type)];
+}
+
+const EnemyArchetype& EnemyWorld::GetArchetype(EnemyType type) const
+{
+    return m_Archetypes[static_cast<int>(type)];
+}
+
+bool EnemyWorld::IsValid(EnemyHandle handle) const
+{
+    uint32_t index = handle.GetIndex();
+    return !handle.IsNull() && index < m_Slots.size() && m_Slots[index].generation == handle.GetGeneration();
+}
+
+bool EnemyWorld::Locate(EnemyHandle handle, EnemyType& type, size_t& row) const
+{
+    if (!IsValid(handle)) return false;
+    const Slot& slot = m_Slots[handle.GetIndex()];
+    type = slot.type;
+    row = slot.row;
+    return true;
+}
+
+const TransformComponent* EnemyWorld::FindTransform(EnemyHandle handle) const
+{
+    EnemyType type;
+    size_t row;
+    if (!Locate(handle, type, row)) return nullptr;
+    return &GetArchetype(type).transforms[row];
+}
+
+EnemyHandle EnemyWorld::AllocateHandle(EnemyType type, size_t row)
+{
+    uint32_t index;
+    if (!m_FreeSlots.empty())
+    {
+        index = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_Slots.size());
+        m_Slots.push_back(Slot{ 1, type, 0 });
+    }
+    Slot& slot = m_Slots[index];
+    slot.type = type;
+    slot.row = static_cast<uint32_t>(row);
+    return EnemyHandle{ index, slot.generation };
+}
+
+void EnemyWorld::RemoveRow(EnemyArchetype& archetype, size_t row)
+{
+    uint32_t index = archetype.handles[row].GetIndex();
+    Slot& slot = m_Slots[index];
+    slot.generation = (slot.generation + 1) & EnemyHandle::GenerationMask;
+    if (slot.generation == 0) slot.generation = 1;
+    m_FreeSlots.push_back(index);
+
+    archetype.Remove(row);
+    // The last row was moved into the hole
+    if (row < archetype.Size())
+        m_Slots[archetype.handles[row].GetIndex()].row = static_cast<uint32_t>(row);
+}
+
+size_t EnemyWorld::GetCount() const
+{
+    size_t count = 0;
+    for (const EnemyArchetype& archetype : m_Archetypes) count += archetype.Size();
+    return count;
+}
+
+int EnemyWorld::RemoveDead(std::vector<Ellipsef>* pRemovedShapes)
+{
+    int removed = 0;
+    for (EnemyArchetype& archetype : m_Archetypes)
+    {
+        for (size_t row = 0; row < archetype.Size(); )
+        {
+            if (archetype.healths[row].health <= 0.f)
+            {
+                if (pRemovedShapes) pRemovedShapes->push_back(archetype.transforms[row].shape);
+                RemoveRow(archetype, row);
+                ++removed;
+            }
+            else
+            {
+                ++row;
+            }
+        }
+    }
+    return removed;
+}
+
+void EnemyWorld::Clear()
+{
+    for (EnemyArchetype& archetype : m_Archetypes)
+    {
+        while (archetype.Size() > 0) RemoveRow(archetype, archetype.Size() - 1);
+    }
+    m_Projectiles.Clear();
+    m_StatusEffects.Clear();
+}
+
+void EnemyWorld::Reset()
+{
+    for (EnemyArchetype& archetype : m_Archetypes) archetype.Clear();
+    m_Slots.clear();
+    m_FreeSlots.clear();
+    m_Projectiles.Clear();
+    m_StatusEffects.Clear();
+}
+
+void EnemyWorld::WriteState(SnapshotWriter& writer) const
+{
+    for (const EnemyArchetype& archetype : m_Archetypes)
+    {
+        writer.WriteU32(static_cast<uint32_t>(archetype.Size()));
+        for (size_t row = 0; row < archetype.Size(); ++row)
+        {
+            writer.WriteU32(archetype.handles[row].value);
+            writer.WriteEllipse(archetype.transforms[row].shape);
+            writer.WriteFloat(archetype.healths[row].health);
+            writer.WriteFloat(archetype.healths[row].maxHealth);
+            const MovementComponent& movement = archetype.movements[row];
+            writer.WriteFloat(movement.speed);
+            writer.WriteFloat(movement.holdDistance);
+            writer.WriteFloat(movement.backOffDistance);
+            writer.WriteFloat(movement.speedScale);
+            if (archetype.Has(Component::MeleeAttack))
+            {
+                const MeleeAttackComponent& attack = archetype.meleeAttacks[row];
+                writer.WriteBool(attack.ready);
+                writer.WriteBool(attack.atTower);
+                writer.WriteInt(attack.powerLevel);
+                writer.WriteFloat(attack.preferredDistance);
+            }
+            if (archetype.Has(Component::RangedAttack))
+            {
+                const RangedAttackComponent& attack = archetype.rangedAttacks[row];
+                writer.WriteFloat(attack.bulletDamage);
+                writer.WriteBool(attack.ready);
+                writer.WriteFloat(attack.cooldownMax);
+                writer.WriteFloat(attack.attackRange);
+                writer.WriteBool(attack.isShooting);
+            }
+            if (archetype.Has(Component::BossBurst))
+            {
+                const BossBurstComponent& burst = archetype.bossBursts[row];
+                writer.WriteFloat(burst.attackSpeed);
+                writer.WriteFloat(burst.bulletDamage);
+                writer.WriteInt(burst.burstCount);
+                writer.WriteFloat(burst.burstDelay);
+                writer.WriteFloat(burst.preferredDistance);
+                writer.WriteInt(burst.powerLevel);
+                writer.WriteInt(burst.burstIndex);
+            }
+            const LodComponent& lod = archetype.lods[row];
+            writer.WriteFloat(lod.elapsed);
+            writer.WriteInt(lod.countdown);
+            writer.WriteBool(lod.active);
+            WriteColor(writer, archetype.renderStyles[row].bodyColor);
+            writer.WriteInt(archetype.renderStyles[row].powerLevel);
+        }
+    }
+    writer.WriteU32(static_cast<uint32_t>(m_Slots.size()));
+    for (const Slot& slot : m_Slots) writer.WriteU32(slot.generation);
+    writer.WriteU32(static_cast<uint32_t>(m_FreeSlots.size()));
+    for (uint32_t index : m_FreeSlots) writer.WriteU32(index);
+    m_Projectiles.WriteState(writer);
+    m_StatusEffects.WriteState(writer);
+}
+
+void EnemyWorld::ReadState(SnapshotReader& reader)
+{
+    Reset();
+    for (EnemyArchetype& archetype : m_Archetypes)
+    {
+        uint32_t count = reader.ReadU32();
+        for (uint32_t row = 0; row < count && reader.IsOk(); ++row)
+        {
+            EnemyHandle handle;
+            handle.value = reader.ReadU32();
+            archetype.handles.push_back(handle);
+            archetype.transforms.push_back(TransformComponent{ reader.ReadEllipse() });
+            HealthComponent health{};
+            health.health = reader.ReadFloat();
+            health.maxHealth = reader.ReadFloat();
+            archetype.healths.push_back(health);
+            MovementComponent movement{};
+            movement.speed = reader.ReadFloat();
+            movement.holdDistance = reader.ReadFloat();
+            movement.backOffDistance = reader.ReadFloat();
+            movement.speedScale = reader.ReadFloat();
+            archetype.movements.push_back(movement);
+            if (archetype.Has(Component::MeleeAttack))
+            {
+                MeleeAttackComponent attack{};
+                attack.ready = reader.ReadBool();
+                attack.atTower = reader.ReadBool();
+                attack.powerLevel = reader.ReadInt();
+                attack.preferredDistance = reader.ReadFloat();
+                archetype.meleeAttacks.push_back(attack);
+            }
+            if (archetype.Has(Component::RangedAttack))
+            {
+                RangedAttackComponent attack{};
+                attack.bulletDamage = reader.ReadFloat();
+                attack.ready = reader.ReadBool();
+                attack.cooldownMax = reader.ReadFloat();
+                attack.attackRange = reader.ReadFloat();
+                attack.isShooting = reader.ReadBool();
+                archetype.rangedAttacks.push_back(attack);
+            }
+            if (archetype.Has(Component::BossBurst))
+            {
+                BossBurstComponent burst{};
+                burst.attackSpeed = reader.ReadFloat();
+                burst.bulletDamage = reader.ReadFloat();
+                burst.burstCount = reader.ReadInt();
+                burst.burstDelay = reader.ReadFloat();
+                burst.preferredDistance = reader.ReadFloat();
+                burst.powerLevel = reader.ReadInt();
+                burst.burstIndex = reader.ReadInt();
+                archetype.bossBursts.push_back(burst);
+            }
+            // Tower targets and steering are recomputed every tick
+            archetype.towerTargets.push_back(TowerTargetComponent{ 0 });
+            archetype.steerings.push_back(SteeringComponent{ Vector2f{ 0.f, 0.f } });
+            LodComponent lod{};
+            lod.elapsed = reader.ReadFloat();
+            lod.countdown = reader.ReadInt();
+            lod.active = reader.ReadBool();
+            archetype.lods.push_back(lod);
+            RenderStyleComponent style{};
+            style.bodyColor = ReadColor(reader);
+            style.powerLevel = reader.ReadInt();
+            archetype.renderStyles.push_back(style);
+        }
+    }
+
+    uint32_t slotCount = reader.ReadU32();
+    for (uint32_t index = 0; index < slotCount && reader.IsOk(); ++index)
+        m_Slots.push_back(Slot{ reader.ReadU32(), EnemyType::Melee, 0 });
+    // Every slot is either free or owned by exactly one live enemy; anything
+    // else would send later handle lookups or allocations out of bounds
+    std::vector<bool> taken(m_Slots.size(), false);
+    uint32_t freeCount = reader.ReadU32();
+    for (uint32_t i = 0; i < freeCount && reader.IsOk(); ++i)
+    {
+        uint32_t index = reader.ReadU32();
+        if (index >= m_Slots.size() || taken[index])
+        {
+            reader.Fail();
+            return;
+        }
+        taken[index] = true;
+        m_FreeSlots.push_back(index);
+    }
+    // Slot locations follow from where each handle's row ended up
+    for (EnemyArchetype& archetype : m_Archetypes)
+    {
+        for (size_t row = 0; row < archetype.handles.size(); ++row)
+        {
+            EnemyHandle handle = archetype.handles[row];
+            uint32_t index = handle.GetIndex();
+            if (index >= m_Slots.size() || taken[index] || m_Slots[index].generation != handle.GetGeneration())
+            {
+                reader.Fail();
+                return;
+            }
+            taken[index] = true;
+            m_Slots[index].type = archetype.type;
+            m_Slots[index].row = static_cast<uint32_t>(row);
+        }
+    }
+    m_Projectiles.ReadState(reader);
+    m_StatusEffects.ReadState(reader);
+}
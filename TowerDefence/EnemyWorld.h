@@ -0,0 +1,98 @@
+#pragma once
+#include "EnemyComponents.h"
+#include "EnemyHandle.h"
+#include "ProjectileStore.h"
+#include "StatusEffects.h"
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Table of all enemies sharing one component set. Each column holds one
+// component per enemy, columns the archetype does not use stay empty.
+struct EnemyArchetype
+{
+    EnemyType type;
+    ComponentMask components;
+    std::vector<TransformComponent> transforms;
+    std::vector<HealthComponent> healths;
+    std::vector<MovementComponent> movements;
+    std::vector<MeleeAttackComponent> meleeAttacks;
+    std::vector<RangedAttackComponent> rangedAttacks;
+    std::vector<BossBurstComponent> bossBursts;
+    std::vector<TowerTargetComponent> towerTargets;
+    std::vector<SteeringComponent> steerings;
+    std::vector<LodComponent> lods;
+    std::vector<RenderStyleComponent> renderStyles;
+    // Which enemy lives in each row, kept in sync with the columns
+    std::vector<EnemyHandle> handles;
+
+    size_t Size() const { return transforms.size(); }
+    bool Has(ComponentMask mask) const { return (components & mask) == mask; }
+    void Remove(size_t row);
+    void Clear();
+};
+
+class EnemyWorld
+{
+public:
+    EnemyWorld();
+    EnemyWorld(const EnemyWorld& other) = delete;
+    EnemyWorld& operator=(const EnemyWorld& other) = delete;
+
+    // Each spawn function appends one row and returns its index in the archetype
+    size_t SpawnMelee(const Ellipsef& shape, int hp, float walkingSpeed);
+    size_t SpawnRanged(const Ellipsef& shape, float hp, float walkingSpeed);
+    size_t SpawnBoss(const Ellipsef& shape, int hp, float walkingSpeed, int waveNumber);
+
+    EnemyArchetype& GetArchetype(EnemyType type);
+    const EnemyArchetype& GetArchetype(EnemyType type) const;
+    EnemyArchetype* GetArchetypes() { return m_Archetypes; }
+    const EnemyArchetype* GetArchetypes() const { return m_Archetypes; }
+    static const int ArchetypeCount{ 3 };
+
+    // Handles stay valid while the enemy exists, whatever rows move around it
+    EnemyHandle GetHandle(EnemyType type, size_t row) const { return GetArchetype(type).handles[row]; }
+    bool IsValid(EnemyHandle handle) const;
+    bool Locate(EnemyHandle handle, EnemyType& type, size_t& row) const;
+    // Null for stale handles
+    const TransformComponent* FindTransform(EnemyHandle handle) const;
+
+    size_t GetCount() const;
+    bool IsEmpty() const { return GetCount() == 0; }
+    // Structural changes are deferred until all systems ran: returns the number
+    // removed, and adds their shapes to pRemovedShapes when given
+    int RemoveDead(std::vector<Ellipsef>* pRemovedShapes = nullptr);
+    // Removes every enemy, all their handles turn stale
+    void Clear();
+    // Clear and also forget the handle table, for a fresh game: whoever holds
+    // handles has to drop them
+    void Reset();
+
+    ProjectileStore& GetProjectiles() { return m_Projectiles; }
+    const ProjectileStore& GetProjectiles() const { return m_Projectiles; }
+    StatusEffects& GetStatusEffects() { return m_StatusEffects; }
+    const StatusEffects& GetStatusEffects() const { return m_StatusEffects; }
+
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+private:
+    struct Slot
+    {
+        uint32_t generation;
+        EnemyType type;
+        uint32_t row;
+    };
+
+    EnemyHandle AllocateHandle(EnemyType type, size_t row);
+    void RemoveRow(EnemyArchetype& archetype, size_t row);
+
+    EnemyArchetype m_Archetypes[ArchetypeCount];
+    std::vector<Slot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    // Shots fired by ranged enemies and bosses, they outlive their shooter
+    ProjectileStore m_Projectiles;
+    // Slows, burns, poisons and stuns, keyed by handle so rows can move
+    StatusEffects m_StatusEffects;
+};
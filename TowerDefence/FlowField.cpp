@@ -0,0 +1,291 @@
+#include "pch.h"
+#include "FlowField.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const uint32_t g_Unreachable{ std::numeric_limits<uint32_t>::max() };
+    const uint32_t g_StraightCost{ 10 };
+    const uint32_t g_DiagonalCost{ 14 };
+
+    const int g_NeighbourX[8]{ 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int g_NeighbourY[8]{ 0, 0, 1, -1, 1, -1, 1, -1 };
+}
+
+FlowField::FlowField(float cellSize)
+    : m_CellSize{ cellSize }
+    , m_InverseCellSize{ 1.f / cellSize }
+    , m_Origin{ 0.f, 0.f }
+    , m_Columns{ 0 }
+    , m_Rows{ 0 }
+    , m_Width{ 0.f }
+    , m_Height{ 0.f }
+    , m_DirtyMinX{ 0 }
+    , m_DirtyMinY{ 0 }
+    , m_DirtyMaxX{ -1 }
+    , m_DirtyMaxY{ -1 }
+    , m_FullBuilds{ 0 }
+    , m_IncrementalBuilds{ 0 }
+    , m_LastUpdatedCells{ 0 }
+    , m_LastBuildMicroseconds{ 0.f }
+{
+}
+
+void FlowField::SetGoals(const std::vector<Vector2f>& goals, float width, float height)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool sameSize = width == m_Width && height == m_Height && !m_Costs.empty();
+    bool onlyAdded = sameSize && goals.size() >= m_Goals.size() &&
+        std::equal(m_Goals.begin(), m_Goals.end(), goals.begin(),
+            [](const Vector2f& a, const Vector2f& b) { return a.x == b.x && a.y == b.y; });
+    if (onlyAdded && goals.size() == m_Goals.size()) return;
+
+    if (onlyAdded)
+    {
+        m_DirtyMinX = m_Columns;
+        m_DirtyMinY = m_Rows;
+        m_DirtyMaxX = -1;
+        m_DirtyMaxY = -1;
+        m_LastUpdatedCells = 0;
+        uint32_t firstNew = static_cast<uint32_t>(m_Goals.size());
+        m_Goals = goals;
+        for (uint32_t goal = firstNew; goal < m_Goals.size(); ++goal)
+            PushGoal(goal);
+        Relax();
+        UpdateDirections(m_DirtyMinX - 1, m_DirtyMinY - 1, m_DirtyMaxX + 1, m_DirtyMaxY + 1);
+        ++m_IncrementalBuilds;
+    }
+    else
+    {
+        m_Width = width;
+        m_Height = height;
+        m_Goals = goals;
+        BuildFull();
+    }
+    m_LastBuildMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FlowField::AddObstacle(const Rectf& area)
+{
+    m_Obstacles.push_back(area);
+    if (!m_Costs.empty()) BuildFull();
+}
+
+void FlowField::ClearObstacles()
+{
+    m_Obstacles.clear();
+    if (!m_Costs.empty()) BuildFull();
+}
+
+Vector2f FlowField::Sample(const Vector2f& position) const
+{
+    if (m_Directions.empty()) return Vector2f{ 0.f, 0.f };
+
+    // Offset by one before truncating so positions just left of the first
+    // cell centre round down instead of towards zero
+    float fx = (position.x - m_Origin.x) * m_InverseCellSize + 0.5f;
+    float fy = (position.y - m_Origin.y) * m_InverseCellSize + 0.5f;
+    int x0 = std::min(std::max(static_cast<int>(fx) - 1, 0), m_Columns - 2);
+    int y0 = std::min(std::max(static_cast<int>(fy) - 1, 0), m_Rows - 2);
+    fx -= 1.f;
+    fy -= 1.f;
+    float tx = std::min(std::max(fx - x0, 0.f), 1.f);
+    float ty = std::min(std::max(fy - y0, 0.f), 1.f);
+
+    const Vector2f* row0 = &m_Directions[y0 * m_Columns + x0];
+    const Vector2f* row1 = row0 + m_Columns;
+    float w00 = (1.f - tx) * (1.f - ty);
+    float w10 = tx * (1.f - ty);
+    float w01 = (1.f - tx) * ty;
+    float w11 = tx * ty;
+    return Vector2f{
+        row0[0].x * w00 + row0[1].x * w10 + row1[0].x * w01 + row1[1].x * w11,
+        row0[0].y * w00 + row0[1].y * w10 + row1[0].y * w01 + row1[1].y * w11 };
+}
+
+void FlowField::BuildFull()
+{
+    // Same one cell border as the enemy grid, since enemies spawn just outside
+    m_Origin = Vector2f{ -m_CellSize, -m_CellSize };
+    m_Columns = std::max(2, static_cast<int>(m_Width / m_CellSize) + 3);
+    m_Rows = std::max(2, static_cast<int>(m_Height / m_CellSize) + 3);
+    size_t cellCount = static_cast<size_t>(m_Columns) * m_Rows;
+    m_Costs.assign(cellCount, g_Unreachable);
+    m_Sources.assign(cellCount, g_Unreachable);
+    m_Blocked.assign(cellCount, 0);
+    m_Directions.assign(cellCount, Vector2f{ 0.f, 0.f });
+
+    for (const Rectf& area : m_Obstacles)
+    {
+        for (int y = GetRow(area.bottom); y <= GetRow(area.bottom + area.height); ++y)
+            for (int x = GetColumn(area.left); x <= GetColumn(area.left + area.width); ++x)
+                m_Blocked[y * m_Columns + x] = 1;
+    }
+
+    m_LastUpdatedCells = 0;
+    for (uint32_t goal = 0; goal < m_Goals.size(); ++goal)
+        PushGoal(goal);
+    Relax();
+    UpdateDirections(0, 0, m_Columns - 1, m_Rows - 1);
+    ++m_FullBuilds;
+}
+
+void FlowField::PushGoal(uint32_t goal)
+{
+    uint32_t cell = static_cast<uint32_t>(GetRow(m_Goals[goal].y) * m_Columns + GetColumn(m_Goals[goal].x));
+    // A tower standing on an obstacle still has to be reachable
+    m_Blocked[cell] = 0;
+    if (!IsBetter(0, goal, cell)) return;
+    m_Costs[cell] = 0;
+    m_Sources[cell] = goal;
+    m_Heap.push_back(Node{ 0, goal, cell });
+    std::push_heap(m_Heap.begin(), m_Heap.end(), HeapOrder);
+}
+
+void FlowField::Relax()
+{
+    while (!m_Heap.empty())
+    {
+        std::pop_heap(m_Heap.begin(), m_Heap.end(), HeapOrder);
+        Node node = m_Heap.back();
+        m_Heap.pop_back();
+        if (node.cost != m_Costs[node.cell] || node.source != m_Sources[node.cell]) continue;
+
+        int x = static_cast<int>(node.cell % m_Columns);
+        int y = static_cast<int>(node.cell / m_Columns);
+        ++m_LastUpdatedCells;
+        m_DirtyMinX = std::min(m_DirtyMinX, x);
+        m_DirtyMinY = std::min(m_DirtyMinY, y);
+        m_DirtyMaxX = std::max(m_DirtyMaxX, x);
+        m_DirtyMaxY = std::max(m_DirtyMaxY, y);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            int nx = x + g_NeighbourX[i];
+            int ny = y + g_NeighbourY[i];
+            if (!IsOpen(nx, ny)) continue;
+            bool diagonal = i >= 4;
+            // No cutting corners past an obstacle
+            if (diagonal && (!IsOpen(nx, y) || !IsOpen(x, ny))) continue;
+
+            uint32_t cell = static_cast<uint32_t>(ny * m_Columns + nx);
+            uint32_t cost = node.cost + (diagonal ? g_DiagonalCost : g_StraightCost);
+            if (IsBetter(cost, node.source, cell))
+            {
+                m_Costs[cell] = cost;
+                m_Sources[cell] = node.source;
+                m_Heap.push_back(Node{ cost, node.source, cell });
+                std::push_heap(m_Heap.begin(), m_Heap.end(), HeapOrder);
+            }
+        }
+    }
+}
+
+bool FlowField::IsBetter(uint32_t cost, uint32_t source, uint32_t cell) const
+{
+    // Equal costs go to the lowest goal index, so the result does not depend
+    // on the order cells were relaxed in
+    return cost < m_Costs[cell] || (cost == m_Costs[cell] && source < m_Sources[cell]);
+}
+
+bool FlowField::HeapOrder(const Node& a, const Node& b)
+{
+    if (a.cost != b.cost) return a.cost > b.cost;
+    if (a.source != b.source) return a.source > b.source;
+    return a.cell > b.cell;
+}
+
+void FlowField::UpdateDirections(int minX, int minY, int maxX, int maxY)
+{
+    minX = std::max(minX, 0);
+    minY = std::max(minY, 0);
+    maxX = std::min(maxX, m_Columns - 1);
+    maxY = std::min(maxY, m_Rows - 1);
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            int cell = y * m_Columns + x;
+            Vector2f& direction = m_Directions[cell];
+            direction = Vector2f{ 0.f, 0.f };
+            if (m_Blocked[cell] || m_Costs[cell] == 0 || m_Costs[cell] == g_Unreachable) continue;
+
+            // With a clear line to its goal a cell points straight at it; the
+            // grid costs only decide which goal that is. Behind obstacles the
+            // cell steps to its cheapest neighbour instead.
+            Vector2f center{ m_Origin.x + (x + 0.5f) * m_CellSize, m_Origin.y + (y + 0.5f) * m_CellSize };
+            const Vector2f& goal = m_Goals[m_Sources[cell]];
+            if (HasLineOfSight(center, goal))
+            {
+                float dx = goal.x - center.x;
+                float dy = goal.y - center.y;
+                float length = std::sqrt(dx * dx + dy * dy);
+                if (length > 0.f)
+                {
+                    direction = Vector2f{ dx / length, dy / length };
+                    continue;
+                }
+            }
+            direction = LowestNeighbourDirection(x, y);
+        }
+    }
+}
+
+bool FlowField::HasLineOfSight(const Vector2f& from, const Vector2f& to) const
+{
+    if (m_Obstacles.empty()) return true;
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    // Half cell steps, so the walk cannot jump over a one cell wall
+    int steps = static_cast<int>(std::sqrt(dx * dx + dy * dy) * 2.f * m_InverseCellSize) + 1;
+    for (int i = 1; i <= steps; ++i)
+    {
+        float t = float(i) / steps;
+        if (m_Blocked[GetRow(from.y + dy * t) * m_Columns + GetColumn(from.x + dx * t)]) return false;
+    }
+    return true;
+}
+
+Vector2f FlowField::LowestNeighbourDirection(int x, int y) const
+{
+    uint32_t lowest = m_Costs[y * m_Columns + x];
+    int best = -1;
+    for (int i = 0; i < 8; ++i)
+    {
+        int nx = x + g_NeighbourX[i];
+        int ny = y + g_NeighbourY[i];
+        if (!IsOpen(nx, ny)) continue;
+        if (i >= 4 && (!IsOpen(nx, y) || !IsOpen(x, ny))) continue;
+        uint32_t cost = m_Costs[ny * m_Columns + nx];
+        if (cost < lowest)
+        {
+            lowest = cost;
+            best = i;
+        }
+    }
+    if (best < 0) return Vector2f{ 0.f, 0.f };
+    const float diagonal = 0.70710678f;
+    return best >= 4
+        ? Vector2f{ g_NeighbourX[best] * diagonal, g_NeighbourY[best] * diagonal }
+        : Vector2f{ float(g_NeighbourX[best]), float(g_NeighbourY[best]) };
+}
+
+bool FlowField::IsOpen(int x, int y) const
+{
+    return x >= 0 && y >= 0 && x < m_Columns && y < m_Rows && !m_Blocked[y * m_Columns + x];
+}
+
+int FlowField::GetColumn(float x) const
+{
+    int column = static_cast<int>(std::floor((x - m_Origin.x) / m_CellSize));
+    return std::min(std::max(column, 0), m_Columns - 1);
+}
+
+int FlowField::GetRow(float y) const
+{
+    int row = static_cast<int>(std::floor((y - m_Origin.y) / m_CellSize));
+    return std::min(std::max(row, 0), m_Rows - 1);
+}
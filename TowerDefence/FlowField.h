@@ -0,0 +1,87 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+#include <cstdint>
+
+// Grid flow field towards the towers. An integration field holds the path cost
+// from every cell to the nearest goal (Dijkstra over 8 neighbours with integer
+// costs 10/14, so incremental and full builds agree exactly), and each cell
+// stores the unit direction along that path. Enemies only sample it, so
+// movement costs the same whatever the level looks like.
+class FlowField
+{
+public:
+    explicit FlowField(float cellSize = 32.f);
+
+    // Goals are the tower centres. Adding goals can only lower costs, so that
+    // case relaxes outward from the new goals alone; any other change (a goal
+    // removed, the window resized) rebuilds the whole field.
+    void SetGoals(const std::vector<Vector2f>& goals, float width, float height);
+    // Cells overlapping an obstacle are impassable; paths route around them
+    void AddObstacle(const Rectf& area);
+    void ClearObstacles();
+
+    // Direction towards the nearest goal, blended bilinearly between the four
+    // surrounding cell centres. Zero on goals and where no path exists; where
+    // the field turns the blend is shorter than one.
+    Vector2f Sample(const Vector2f& position) const;
+
+    float GetCellSize() const { return m_CellSize; }
+    int GetColumns() const { return m_Columns; }
+    int GetRows() const { return m_Rows; }
+    uint32_t GetFullBuildCount() const { return m_FullBuilds; }
+    uint32_t GetIncrementalBuildCount() const { return m_IncrementalBuilds; }
+    // Cells whose cost changed in the last build
+    uint32_t GetLastUpdatedCells() const { return m_LastUpdatedCells; }
+    float GetLastBuildMicroseconds() const { return m_LastBuildMicroseconds; }
+
+private:
+    struct Node
+    {
+        uint32_t cost;
+        uint32_t source;
+        uint32_t cell;
+    };
+
+    // Min-heap order for std::push_heap/pop_heap
+    static bool HeapOrder(const Node& a, const Node& b);
+    bool IsBetter(uint32_t cost, uint32_t source, uint32_t cell) const;
+
+    void BuildFull();
+    // Dijkstra from the queued nodes; only touches cells it can improve
+    void Relax();
+    void PushGoal(uint32_t goal);
+    void UpdateDirections(int minX, int minY, int maxX, int maxY);
+    Vector2f LowestNeighbourDirection(int x, int y) const;
+    bool HasLineOfSight(const Vector2f& from, const Vector2f& to) const;
+    bool IsOpen(int x, int y) const;
+    int GetColumn(float x) const;
+    int GetRow(float y) const;
+
+    float m_CellSize;
+    float m_InverseCellSize;
+    Vector2f m_Origin;
+    int m_Columns;
+    int m_Rows;
+    float m_Width;
+    float m_Height;
+    std::vector<uint32_t> m_Costs;
+    // Index of the goal each cell's cheapest path leads to
+    std::vector<uint32_t> m_Sources;
+    std::vector<uint8_t> m_Blocked;
+    std::vector<Vector2f> m_Directions;
+    std::vector<Vector2f> m_Goals;
+    std::vector<Rectf> m_Obstacles;
+    std::vector<Node> m_Heap;
+
+    // Bounding box of the cells the last relaxation changed
+    int m_DirtyMinX;
+    int m_DirtyMinY;
+    int m_DirtyMaxX;
+    int m_DirtyMaxY;
+
+    uint32_t m_FullBuilds;
+    uint32_t m_IncrementalBuilds;
+    uint32_t m_LastUpdatedCells;
+    float m_LastBuildMicroseconds;
+};
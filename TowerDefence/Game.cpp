@@ -1,7 +1,19 @@
 #include "pch.h"
 #include "Game.h"
 #include "Tower.h"
-#include "EnemyBase.h"
+#include "TowerIndex.h"
+#include "EnemyGrid.h"
+#include "AreaDamage.h"
+#include "ParticleSystem.h"
+#include "SwarmRenderer.h"
+#include "CircleRenderer.h"
+#include "FlowField.h"
+#include "WorkerPool.h"
+#include "EnemyWorld.h"
+#include "EnemySystems.h"
+#include "SystemScheduler.h"
+#include "TimingWheel.h"
+#include "ScriptRuntime.h"
 #include "Bullet.h"
 #include "utils.h"
 #include <iostream>
@@ -10,27 +22,80 @@
 #include <iomanip>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 #include "Texture.h"
-#include "RangedEnemy.h"
-#include "BossEnemy.h"
-#include "MeleeEnemy.h"
 #include "Upgrade.h"
+#include "Replay.h"
+#include "Random.h"
+#include "StateHash.h"
+#include "Snapshot.h"
+#include "RewindBuffer.h"
+#include "Scenario.h"
+#include <chrono>
+
+namespace
+{
+    const char g_SnapshotMagic[4]{ 'T', 'D', 'S', 'S' };
+    const uint32_t g_SnapshotVersion{ 15 };
+    // Below this many towers waking the worker threads costs more than it saves
+    const size_t g_MinParallelTowers{ 16 };
+
+    const float g_EnemyRadius{ 15.f };
+    const float g_TwoPi{ 6.28318531f };
+
+    // Horde mode multiplies the enemies of a normal wave and spawns them in
+    // batches, so the field fills in seconds instead of minutes
+    const int g_HordeWaveScale{ 100 };
+    const int g_HordeSpawnBatch{ 50 };
+    const int g_HordeMaxEnemies{ 100000 };
+    // Scenario rings are this far apart, the innermost at 40% of the shorter window side
+    const int g_ScenarioRingCount{ 8 };
+    const float g_ScenarioRingSpacing{ 24.f };
+
+    // Steps of the wave script, kept in ScriptFrame::step
+    enum WaveStep
+    {
+        WaveStart,
+        WaveSpawn,
+        WaveClear
+    };
+}
 
 Game::Game(const Window& window)
     : BaseGame{ window }
     , m_pTower{ nullptr }
+    , m_pTowerIndex{ new TowerIndex{} }
+    , m_TowerIndexDirty{ true }
+    , m_TowerCharges{ 1 }
+    , m_pEnemyGrid{ new EnemyGrid{} }
+    , m_pAreaDamage{ new AreaDamage{} }
+    , m_pParticles{ new ParticleSystem{} }
+    , m_pSwarmRenderer{ new SwarmRenderer{} }
+    , m_pCircles{ new CircleRenderer{} }
+    , m_pFlowField{ new FlowField{} }
+    , m_pWorkerPool{ new WorkerPool{} }
+    , m_TowerUpdateMicroseconds{ 0.f }
+    , m_TimerUpdateMicroseconds{ 0.f }
+    , m_CleanupMicroseconds{ 0.f }
+    , m_DrawMicroseconds{ 0.f }
+    , m_LodNearCount{ 0 }
+    , m_LodDistantCount{ 0 }
+    , m_LodDistantUpdatedCount{ 0 }
+    , m_pEnemyWorld{ new EnemyWorld{} }
+    , m_pScheduler{ new SystemScheduler{} }
+    , m_pTimers{ new TimingWheel{} }
+    , m_pScripts{ new ScriptRuntime{ *m_pTimers } }
     , m_GameState{ GameState::Playing }
     , m_CurrentWave{ 1 }
     , m_EnemiesKilled{ 0 }
     , m_EnemiesRequiredForWave{ 5 }
     , m_WaveInProgress{ true }
-    , m_EnemySpawnTimer{ 0.f }
     , m_EnemySpawnInterval{ 2.f }
     , m_MaxEnemies{ 10 }
+    , m_HordeMode{ false }
     , m_TowerHealth{ 100 }
     , m_MaxTowerHealth{ 100 }
     , m_RangedEnemyChance{ 20 }
-    , m_BossSpawned{ false }
     , m_SelectedUpgrade{ 0 }
     , m_Width{ window.width }
     , m_Height{ window.height }
@@ -42,15 +107,74 @@ Game::Game(const Window& window)
     , m_NotificationTimer{ -1.0f }
     , m_HighScore{ 0 }
     , m_Score{ 0 }
+    , m_pDamageCardTexture{ nullptr }
+    , m_pAttackSpeedCardTexture{ nullptr }
+    , m_pRangeCardTexture{ nullptr }
+    , m_pRepairCardTexture{ nullptr }
+    , m_pRicocheetTexture{ nullptr }
+    , m_pBackgroundTexture{ nullptr }
     , m_bRunning{ true } 
+    , m_TickRate{ 60 }
+    , m_TickDuration{ 1.f / 60.f }
+    , m_TickAccumulator{ 0.f }
+    , m_TickCount{ 0 }
+    , m_pReplay{ nullptr }
+    , m_IsRecording{ false }
+    , m_IsPlayingBack{ false }
+    , m_ReplayEventIndex{ 0 }
+    , m_PlaybackSeconds{ 0.f }
+    , m_pHashLog{ nullptr }
+    , m_pRewindBuffer{ new RewindBuffer{ 300, 16 * 1024 * 1024, 10 } }
+    , m_LastRewindWave{ 0 }
+    , m_RestartMicroseconds{ 0.f }
+    , m_ShowDebugOverlay{ false }
+    , m_pScenario{ nullptr }
+    , m_ScenarioTimings{}
 {
+    EnemySystems::Register(*m_pScheduler);
     Initialize();
     LoadHighScore();
 }
 
 Game::~Game()
 {
+    if (m_IsRecording && m_pReplay)
+    {
+        m_pReplay->SetTickCount(m_TickCount);
+        if (m_pReplay->SaveToFile(m_ReplayPath))
+            std::cout << "Saved replay (" << m_TickCount << " ticks) to " << m_ReplayPath << std::endl;
+    }
+    delete m_pReplay;
+    m_pReplay = nullptr;
+    delete m_pHashLog;
+    m_pHashLog = nullptr;
+    delete m_pRewindBuffer;
+    m_pRewindBuffer = nullptr;
     Cleanup();
+    delete m_pEnemyWorld;
+    m_pEnemyWorld = nullptr;
+    delete m_pScheduler;
+    m_pScheduler = nullptr;
+    delete m_pScripts;
+    m_pScripts = nullptr;
+    delete m_pTimers;
+    m_pTimers = nullptr;
+    delete m_pTowerIndex;
+    m_pTowerIndex = nullptr;
+    delete m_pEnemyGrid;
+    m_pEnemyGrid = nullptr;
+    delete m_pAreaDamage;
+    m_pAreaDamage = nullptr;
+    delete m_pParticles;
+    m_pParticles = nullptr;
+    delete m_pSwarmRenderer;
+    m_pSwarmRenderer = nullptr;
+    delete m_pCircles;
+    m_pCircles = nullptr;
+    delete m_pFlowField;
+    m_pFlowField = nullptr;
+    delete m_pWorkerPool;
+    m_pWorkerPool = nullptr;
 }
 
 bool Game::IsGameRunning() const
@@ -65,6 +189,7 @@ void Game::Initialize()
     float centerX = m_Width / 2.f - towerWidth / 2.f;
     float centerY = m_Height / 2.f - towerHeight / 2.f + 75.0f;
     m_pTower = new Tower{ Rectf{centerX, centerY, towerWidth, towerHeight}, 150.f, 1.f };
+    m_Towers.push_back(m_pTower);
     InitializeFonts();
     try {
         m_pDamageCardTexture = new Texture("Resources/DamageUpgrade.png");
@@ -78,14 +203,15 @@ void Game::Initialize()
         std::cerr << "Texture loading error: " << e.what() << std::endl;
     }
     SetupUpgradeOptions();
+    m_pScripts->Start(ScriptType::Wave, 0);
 }
 
 void Game::Cleanup()
 {
-    delete m_pTower;
+    for (Tower* tower : m_Towers) delete tower;
+    m_Towers.clear();
     m_pTower = nullptr;
-    for (EnemyBase* enemy : m_pEnemies) delete enemy;
-    m_pEnemies.clear();
+    m_pEnemyWorld->Clear();
     for (Upgrade* upgrade : m_AvailableUpgrades) delete upgrade;
     m_AvailableUpgrades.clear();
     delete m_pDamageCardTexture;
@@ -98,17 +224,27 @@ void Game::Cleanup()
     m_pRangeCardTexture = nullptr;
     m_pRepairCardTexture = nullptr;
     m_pRicocheetTexture = nullptr;
+    delete m_pBackgroundTexture;
+    m_pBackgroundTexture = nullptr;
 }
 
 void Game::SetupUpgradeOptions()
 {
-    for (Upgrade* upgrade : m_AvailableUpgrades) delete upgrade;
-    m_AvailableUpgrades.clear();
+    // The cards never change, so they and their text textures are built once
+    if (!m_AvailableUpgrades.empty()) return;
     Upgrade* dmg = Upgrade::CreateDamageUpgrade(2.0f);
     Upgrade* spd = Upgrade::CreateAttackSpeedUpgrade(0.3f);
     Upgrade* rng = Upgrade::CreateRangeUpgrade(30.0f);
     Upgrade* rep = Upgrade::CreateRepairUpgrade(25);
     Upgrade* rico = Upgrade::CreateRicochetUpgrade(1);
+    Upgrade* target = Upgrade::CreateTargetingUpgrade();
+    Upgrade* splash = Upgrade::CreateSplashUpgrade(25.0f);
+    Upgrade* explosive = Upgrade::CreateExplosiveUpgrade(2.0f);
+    Upgrade* chain = Upgrade::CreateChainLightningUpgrade(2);
+    Upgrade* frost = Upgrade::CreateFrostUpgrade(0.15f);
+    Upgrade* fire = Upgrade::CreateIncendiaryUpgrade(3.0f);
+    Upgrade* venom = Upgrade::CreateVenomUpgrade(1.0f);
+    Upgrade* stun = Upgrade::CreateConcussionUpgrade(0.1f);
 
     if (m_pDamageCardTexture) dmg->SetTexture(m_pDamageCardTexture);
     if (m_pAttackSpeedCardTexture) spd->SetTexture(m_pAttackSpeedCardTexture);
@@ -116,7 +252,7 @@ void Game::SetupUpgradeOptions()
     if (m_pRepairCardTexture) rep->SetTexture(m_pRepairCardTexture);
     if (m_pRicocheetTexture) rico->SetTexture(m_pRicocheetTexture);
 
-    for (Upgrade* upg : { dmg, spd, rng, rep, rico }) {
+    for (Upgrade* upg : { dmg, spd, rng, rep, rico, target, splash, explosive, chain, frost, fire, venom, stun }) {
         upg->SetFontStyle(m_HeaderFontPath, m_MainFontPath,
             m_SmallFontSize + 2, m_SmallFontSize,
             m_HighlightColor, m_NormalColor);
@@ -127,140 +263,151 @@ void Game::SetupUpgradeOptions()
     m_AvailableUpgrades.push_back(rng);
     m_AvailableUpgrades.push_back(rep);
     m_AvailableUpgrades.push_back(rico);
+    m_AvailableUpgrades.push_back(target);
+    m_AvailableUpgrades.push_back(splash);
+    m_AvailableUpgrades.push_back(explosive);
+    m_AvailableUpgrades.push_back(chain);
+    m_AvailableUpgrades.push_back(frost);
+    m_AvailableUpgrades.push_back(fire);
+    m_AvailableUpgrades.push_back(venom);
+    m_AvailableUpgrades.push_back(stun);
 }
 
 void Game::Update(float elapsedSec)
 {
-    switch (m_GameState)
+    m_pParticles->Update(elapsedSec);
+    for (auto& notification : m_UiNotifications) notification.second -= elapsedSec;
+    m_UiNotifications.erase(
+        std::remove_if(m_UiNotifications.begin(), m_UiNotifications.end(),
+            [](const std::pair<std::string, float>& notification) { return notification.second <= 0.f; }),
+        m_UiNotifications.end());
+    if (m_pScenario)
     {
-    case GameState::Playing: {
-        m_pTower->Update(elapsedSec, m_pEnemies, m_Width, m_Height);
-        m_IsBossWave = (m_CurrentWave % 5 == 0);
-        m_EnemySpawnTimer += elapsedSec;
-        bool shouldSpawnEnemy =
-            m_WaveInProgress &&
-            (m_EnemiesSpawnedInWave < m_EnemiesRequiredForWave) &&
-            (m_pEnemies.size() < m_MaxEnemies) &&
-            (m_EnemySpawnTimer >= m_EnemySpawnInterval);
-
-        if (shouldSpawnEnemy)
+        m_ScenarioTimings.particles += m_pParticles->GetLastUpdateMicroseconds();
+        m_ScenarioTimings.draw += m_DrawMicroseconds;
+        ++m_ScenarioTimings.frames;
+    }
+    if (m_IsPlayingBack)
+    {
+        // Max speed: simulate for roughly one frame's worth of wall time, then draw
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (m_bRunning && !IsPlaybackFinished() &&
+            std::chrono::steady_clock::now() - start < std::chrono::milliseconds(16))
         {
-            m_EnemiesSpawnedInWave++;
-            m_EnemySpawnTimer = 0.f;
-            if (m_IsBossWave && !m_BossSpawned)
-            {
-                SpawnEnemy(EnemySpawnType::Boss);
-                m_BossSpawned = true;
-            }
-            else if (!m_IsBossWave)
-            {
-                EnemySpawnType type = (rand() % 100 < m_RangedEnemyChance)
-                    ? EnemySpawnType::Ranged
-                    : EnemySpawnType::Normal;
-                SpawnEnemy(type);
-            }
+            StepSimulation();
+        }
+        m_PlaybackSeconds += std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        if (IsPlaybackFinished())
+        {
+            PrintPlaybackStats(m_PlaybackSeconds);
+            m_bRunning = false;
         }
+        return;
+    }
 
-        float towerCenterX = m_pTower->GetPosition().left + m_pTower->GetPosition().width / 2.f;
-        float towerCenterY = m_pTower->GetPosition().bottom + m_pTower->GetPosition().height / 2.f;
+    m_TickAccumulator += elapsedSec;
+    while (m_TickAccumulator >= m_TickDuration)
+    {
+        m_TickAccumulator -= m_TickDuration;
+        StepSimulation();
+    }
+}
 
-        for (size_t i = 0; i < m_pEnemies.size(); )
-        {
-            EnemyBase* enemy = m_pEnemies[i];
-            enemy->Update(towerCenterX, towerCenterY, elapsedSec);
-            switch (enemy->GetType())
-            {
-            case EnemyType::Ranged:
-                static_cast<RangedEnemy*>(enemy)->ShootIfAble(towerCenterX, towerCenterY, elapsedSec);
-                break;
-            case EnemyType::Boss:
-                static_cast<BossEnemy*>(enemy)->Attack(elapsedSec, m_pTower->GetPosition());
-                break;
-            default:
-                break;
-            }
+void Game::StepSimulation()
+{
+    if (m_IsPlayingBack)
+        DispatchReplayEvents();
+    UpdateSimulation(m_TickDuration);
+    if (m_pScenario)
+        AddScenarioTick();
+    if (m_pHashLog)
+        m_pHashLog->Write(m_TickCount, ComputeStateHash());
+    ++m_TickCount;
+    if (!m_IsPlayingBack && m_GameState == GameState::Playing &&
+        (m_CurrentWave != m_LastRewindWave || m_TickCount % m_TickRate == 0))
+    {
+        CaptureRewindPoint();
+    }
+}
 
-            if (ProcessBulletCollisions(enemy))
-            {
-                delete enemy;
-                std::swap(m_pEnemies[i], m_pEnemies.back());
-                m_pEnemies.pop_back();
-                m_EnemiesKilled++;
-            }
-            else
-            {
-                ++i;
-            }
+void Game::UpdateSimulation(float elapsedSec)
+{
+    switch (m_GameState)
+    {
+    case GameState::Playing: {
+        bool towersChanged = m_TowerIndexDirty;
+        if (m_TowerIndexDirty)
+        {
+            m_pTowerIndex->Build(m_Towers, m_Width, m_Height);
+            std::vector<Vector2f> goals;
+            for (const Tower* tower : m_Towers) goals.push_back(tower->GetCenter());
+            m_pFlowField->SetGoals(goals, m_Width, m_Height);
+            m_TowerIndexDirty = false;
         }
-
-        Rectf towerRect = m_pTower->GetPosition();
-        Ellipsef towerEllipse(
-            towerRect.left + towerRect.width / 2.0f,
-            towerRect.bottom + towerRect.height / 2.0f,
-            towerRect.width / 2.0f,
-            towerRect.height / 2.0f
-        );
-
-        for (EnemyBase* enemy : m_pEnemies)
+        m_IsBossWave = (m_CurrentWave % 5 == 0);
+        std::chrono::steady_clock::time_point timersStart = std::chrono::steady_clock::now();
+        const std::vector<Timer>& dueTimers = m_pTimers->Advance();
+        for (const Timer& timer : dueTimers)
         {
-            if (enemy->GetType() == EnemyType::Ranged)
-            {
-                RangedEnemy* ranged = static_cast<RangedEnemy*>(enemy);
-                ranged->UpdateBullets(elapsedSec, m_Width, m_Height);
-                for (Bullet& bullet : ranged->GetBullets())
-                {
-                    if (bullet.IsActive() && bullet.CheckHit(towerEllipse))
-                    {
-                        UpdateTowerHealth(-bullet.GetDamage());
-                        bullet.Deactivate();
-                    }
-                }
-            }
-            else if (enemy->GetType() == EnemyType::Boss)
-            {
-                BossEnemy* boss = static_cast<BossEnemy*>(enemy);
-                for (Bullet& bullet : boss->GetBullets())
-                {
-                    if (bullet.IsActive() && bullet.CheckHit(towerEllipse))
-                    {
-                        UpdateTowerHealth(-bullet.GetDamage());
-                        bullet.Deactivate();
-                    }
-                }
-            }
+            // Script and enemy timers are left to the script runtime and the enemy systems
+            if (timer.kind == TimerKind::NotificationExpiry)
+                ExpireNotifications();
         }
+        m_pScripts->BeginTick();
+        m_TimerUpdateMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - timersStart).count();
 
-        CheckWaveComplete();
+        m_TowerDamage.assign(m_Towers.size(), 0);
+        SimulationContext context{};
+        context.elapsedSec = elapsedSec;
+        context.pTowers = &m_Towers;
+        context.pTowerIndex = m_pTowerIndex;
+        context.pFlowField = m_pFlowField;
+        context.pEnemyGrid = m_pEnemyGrid;
+        context.pAreaDamage = m_pAreaDamage;
+        context.pParticles = m_pParticles;
+        context.pTimers = m_pTimers;
+        context.pDueTimers = &dueTimers;
+        context.pScripts = m_pScripts;
+        context.windowWidth = m_Width;
+        context.windowHeight = m_Height;
+        context.towersChanged = towersChanged;
+        context.pTowerDamage = &m_TowerDamage;
+        context.pTowerShapes = &m_TowerShapes;
+        m_pScheduler->Run(*m_pEnemyWorld, context);
+        m_LodNearCount = context.nearCount;
+        m_LodDistantCount = context.distantCount;
+        m_LodDistantUpdatedCount = context.distantUpdatedCount;
 
-        if (ProcessEnemyAttacks(elapsedSec) || m_TowerHealth <= 0)
+        // Towers aim with the grid the systems just built, before rows move
+        UpdateTowers(elapsedSec);
+
+        std::chrono::steady_clock::time_point cleanupStart = std::chrono::steady_clock::now();
+        m_RemovedShapes.clear();
+        int killed = m_pEnemyWorld->RemoveDead(&m_RemovedShapes);
+        for (const Ellipsef& shape : m_RemovedShapes)
+            m_pParticles->Emit(ParticleEffect::Kill, shape.center, shape.radiusX / 10.f);
+        if (killed > 0)
         {
-            if (m_TowerHealth <= 0 && m_GameState != GameState::GameOver)
-            {
-                // Save high score before transitioning to game over
-                if (m_CurrentWave > m_HighScore) {
-                    m_HighScore = m_CurrentWave;
-                    SaveHighScore();
-                }
-                m_GameState = GameState::GameOver;
-                for (auto enemy : m_pEnemies) delete enemy;
-                m_pEnemies.clear();
-            }
+            m_EnemiesKilled += killed;
+            m_pScripts->Signal(ScriptEvent::EnemyKilled);
         }
+        if (m_TowerDamage[0] > 0)
+            UpdateTowerHealth(-m_TowerDamage[0]);
+        DamagePlacedTowers();
+
+        // After the kills, so the wave ends on the tick its last enemy dies
+        m_pScripts->Resume(ScriptType::Wave, dueTimers, [this](ScriptFrame& frame) { return ResumeWaveScript(frame); });
+        m_CleanupMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - cleanupStart).count();
 
-        for (size_t i = 0; i < m_Notifications.size(); )
+        if (m_TowerHealth <= 0 && m_GameState != GameState::GameOver)
         {
-            if (m_Notifications[i].second >= 0.0f)
-            {
-                m_Notifications[i].second -= elapsedSec;
-                if (m_Notifications[i].second <= 0)
-                    m_Notifications.erase(m_Notifications.begin() + i);
-                else
-                    ++i;
-            }
-            else
-            {
-                m_Notifications.erase(m_Notifications.begin() + i);
+            // Save high score before transitioning to game over
+            if (m_CurrentWave > m_HighScore) {
+                m_HighScore = m_CurrentWave;
+                SaveHighScore();
             }
+            m_GameState = GameState::GameOver;
+            m_pEnemyWorld->Clear();
         }
         break;
     }
@@ -273,37 +420,30 @@ void Game::Update(float elapsedSec)
 
 void Game::Draw() const
 {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_pCircles->BeginFrame();
     ClearBackground();
     if (m_pBackgroundTexture) {
         m_pBackgroundTexture->Draw(Rectf{ 0.0f, 0.0f, float(m_Width), float(m_Height) });
     }
-    m_pTower->Draw();
-    for (const EnemyBase* enemy : m_pEnemies) {
-        enemy->Draw();
-    }
-    for (const EnemyBase* enemy : m_pEnemies) {
-        if (enemy->GetType() == EnemyType::Ranged) {
-            const RangedEnemy* ranged = static_cast<const RangedEnemy*>(enemy);
-            for (const Bullet& bullet : ranged->GetBullets()) {
-                if (bullet.IsActive()) bullet.Draw();
-            }
-        }
-        else if (enemy->GetType() == EnemyType::Boss) {
-            const BossEnemy* boss = static_cast<const BossEnemy*>(enemy);
-            for (const Bullet& bullet : boss->GetBullets()) {
-                if (bullet.IsActive()) bullet.Draw();
-            }
+    for (const Tower* tower : m_Towers) tower->Draw(*m_pCircles);
+    m_pCircles->Flush();
+    for (const Tower* tower : m_Towers) tower->DrawTracers();
+    m_pSwarmRenderer->Draw(*m_pEnemyWorld, *m_pCircles, m_Width, m_Height);
+    m_pAreaDamage->Draw(*m_pCircles);
+    m_pParticles->Draw();
+    for (Tower* tower : m_Towers) {
+        for (const Bullet& bullet : tower->GetBullets()) {
+            if (bullet.IsActive()) bullet.Draw(*m_pCircles);
         }
     }
-    for (const Bullet& bullet : m_pTower->GetBullets()) {
-        if (bullet.IsActive()) bullet.Draw();
-    }
+    m_pCircles->Flush();
     switch (m_GameState)
     {
     case GameState::Playing:
     {
         std::stringstream ss;
-        ss << "WAVE " << m_CurrentWave;
+        ss << (m_HordeMode ? "HORDE WAVE " : "WAVE ") << m_CurrentWave;
         Texture waveText(ss.str(), m_HeaderFontPath, m_HeadingFontSize, m_TitleColor);
         waveText.Draw(Vector2f(m_Width / 2.f - waveText.GetWidth() / 2.f, m_Height - 40.f));
         ss.str("");
@@ -348,7 +488,9 @@ void Game::Draw() const
             "SPEED: " + spdStr,
             "RANGE: " + rngStr,
             "BOUNCE: " + ricStr,
-            "HEALTH: " + healthStr + " / " + maxHealthStr
+            std::string("TARGET: ") + GetTargetingPolicyName(m_pTower->GetTargetingPolicy()),
+            "HEALTH: " + healthStr + " / " + maxHealthStr,
+            "TOWERS TO PLACE: " + std::to_string(m_TowerCharges)
         };
         for (const auto& line : statLines) {
             Texture statText(line, m_MainFontPath, m_SmallFontSize, m_StatsColor);
@@ -367,30 +509,15 @@ void Game::Draw() const
         Color4f healthColor(1.0f - healthPercent, healthPercent, 0.0f, 1.0f);
         utils::SetColor(healthColor);
         utils::FillRect(Rectf(barX, barY, barWidth * healthPercent, barHeight));
-        if (!m_Notifications.empty()) {
-            float notifY = m_Height - 160.f;
-            for (const auto& notification : m_Notifications) {
-                float alpha = 1.0f;
-                if (notification.second < 1.0f) {
-                    alpha = notification.second;
-                }
-                else if (notification.first.find("WARNING") != std::string::npos) {
-                    alpha = 0.7f + 0.3f * sin(SDL_GetTicks() * 0.008f);
-                }
-                Color4f notifColor;
-                if (notification.first.find("WARNING") != std::string::npos) {
-                    notifColor = Color4f(1.0f, 0.2f, 0.2f, alpha);
-                }
-                else if (notification.first.find("LEVEL") != std::string::npos) {
-                    notifColor = Color4f(1.0f, 0.7f, 0.2f, alpha);
-                }
-                else {
-                    notifColor = Color4f(1.0f, 1.0f, 1.0f, alpha);
-                }
-                Texture notifText(notification.first, m_HeaderFontPath, m_NormalFontSize, notifColor);
-                notifText.Draw(Vector2f(m_Width / 2.f - notifText.GetWidth() / 2.f, notifY));
-                notifY -= 30.f;
-            }
+        float notifY = m_Height - 160.f;
+        for (const auto& notification : m_Notifications) {
+            float remaining = static_cast<int>(notification.second - m_pTimers->GetTick()) * m_TickDuration;
+            DrawNotification(notification.first, remaining, notifY);
+            notifY -= 30.f;
+        }
+        for (const auto& notification : m_UiNotifications) {
+            DrawNotification(notification.first, notification.second, notifY);
+            notifY -= 30.f;
         }
     }
     break;
@@ -401,33 +528,43 @@ void Game::Draw() const
         GameOver();
         break;
     }
+    if (m_ShowDebugOverlay)
+        DrawDebugOverlay();
+    m_DrawMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
 }
 
 void Game::SpawnEnemy(EnemySpawnType type)
 {
     float spawnX = 0.0f, spawnY = 0.0f;
-    float radius = 15.f;
-    int edge = rand() % 4;
+    const float radius = g_EnemyRadius;
+    int edge = Random::NextInt(4);
     switch (edge)
     {
     case 0:
-        spawnX = float(rand() % int(m_Width));
+        spawnX = float(Random::NextInt(int(m_Width)));
         spawnY = m_Height + radius;
         break;
     case 1:
         spawnX = m_Width + radius;
-        spawnY = float(rand() % int(m_Height));
+        spawnY = float(Random::NextInt(int(m_Height)));
         break;
     case 2:
-        spawnX = float(rand() % int(m_Width));
+        spawnX = float(Random::NextInt(int(m_Width)));
         spawnY = -radius;
         break;
     case 3:
         spawnX = -radius;
-        spawnY = float(rand() % int(m_Height));
+        spawnY = float(Random::NextInt(int(m_Height)));
         break;
     }
-    EnemyBase* enemy = nullptr;
+    SpawnEnemy(type, Vector2f{ spawnX, spawnY });
+}
+
+void Game::SpawnEnemy(EnemySpawnType type, const Vector2f& position)
+{
+    const float spawnX = position.x;
+    const float spawnY = position.y;
+    const float radius = g_EnemyRadius;
     switch (type)
     {
     case EnemySpawnType::Normal:
@@ -435,11 +572,13 @@ void Game::SpawnEnemy(EnemySpawnType type)
         int baseHp = 1 + m_CurrentWave;
         int hp = baseHp * (1 + m_BossWavesCompleted * 0.3f);
         float speed = 40.f + (m_CurrentWave * 3.f);
-        MeleeEnemy* meleeEnemy = new MeleeEnemy(Ellipsef(spawnX, spawnY, radius, radius), hp, speed);
+        size_t row = m_pEnemyWorld->SpawnMelee(Ellipsef(spawnX, spawnY, radius, radius), hp, speed);
         if (m_BossWavesCompleted > 0) {
-            meleeEnemy->m_AttackCooldown = std::max(0.3f, 1.0f / m_EnemyAttackSpeedMultiplier);
+            MeleeAttackComponent& attack = m_pEnemyWorld->GetArchetype(EnemyType::Melee).meleeAttacks[row];
+            attack.ready = false;
+            m_pTimers->ScheduleIn(TimingWheel::ToTicks(std::max(0.3f, 1.0f / m_EnemyAttackSpeedMultiplier), m_TickDuration),
+                TimerKind::MeleeReady, m_pEnemyWorld->GetHandle(EnemyType::Melee, row).value);
         }
-        enemy = meleeEnemy;
     }
     break;
     case EnemySpawnType::Ranged:
@@ -447,12 +586,12 @@ void Game::SpawnEnemy(EnemySpawnType type)
         int baseHp = 3 + static_cast<int>(m_CurrentWave * 0.7f);
         int hp = baseHp * (1 + m_BossWavesCompleted * 0.3f);
         float speed = 30.f + (m_CurrentWave * 2.f);
-        RangedEnemy* rangedEnemy = new RangedEnemy(Ellipsef(spawnX, spawnY, radius, radius), hp, speed);
+        size_t row = m_pEnemyWorld->SpawnRanged(Ellipsef(spawnX, spawnY, radius, radius), float(hp), speed);
         if (m_BossWavesCompleted > 0) {
-            rangedEnemy->m_BulletDamage *= m_EnemyDamageMultiplier;
-            rangedEnemy->m_ShootCooldownMax = std::max(0.4f, 1.0f / m_EnemyAttackSpeedMultiplier);
+            RangedAttackComponent& attack = m_pEnemyWorld->GetArchetype(EnemyType::Ranged).rangedAttacks[row];
+            attack.bulletDamage *= m_EnemyDamageMultiplier;
+            attack.cooldownMax = std::max(0.4f, 1.0f / m_EnemyAttackSpeedMultiplier);
         }
-        enemy = rangedEnemy;
     }
     break;
     case EnemySpawnType::Boss:
@@ -461,25 +600,67 @@ void Game::SpawnEnemy(EnemySpawnType type)
         int hp = baseHp * (1 + m_BossWavesCompleted * 0.2f);
         float speed = 25.f + (m_CurrentWave * 1.5f);
         float bossRadius = radius * 1.8f;
-        BossEnemy* bossEnemy = new BossEnemy(Ellipsef(spawnX, spawnY, bossRadius, bossRadius), hp, speed, m_CurrentWave);
+        size_t row = m_pEnemyWorld->SpawnBoss(Ellipsef(spawnX, spawnY, bossRadius, bossRadius), hp, speed, m_CurrentWave);
+        m_pScripts->Start(ScriptType::BossBurst, m_pEnemyWorld->GetArchetype(EnemyType::Boss).handles[row].value);
         if (m_BossWavesCompleted > 0) {
-            bossEnemy->SetBulletDamage(bossEnemy->GetBulletDamage() * m_EnemyDamageMultiplier);
-            bossEnemy->SetAttackSpeed(bossEnemy->GetAttackSpeed() * m_EnemyAttackSpeedMultiplier);
+            BossBurstComponent& burst = m_pEnemyWorld->GetArchetype(EnemyType::Boss).bossBursts[row];
+            burst.bulletDamage *= m_EnemyDamageMultiplier;
+            burst.attackSpeed *= m_EnemyAttackSpeedMultiplier;
         }
-        enemy = bossEnemy;
     }
     break;
     }
-    if (enemy != nullptr)
-        m_pEnemies.push_back(enemy);
 }
 
 void Game::ProcessKeyDownEvent(const SDL_KeyboardEvent& e)
+{
+    if (m_IsPlayingBack)
+    {
+        if (e.keysym.sym == SDLK_ESCAPE) m_bRunning = false;
+        return;
+    }
+    // Quick save / load are not part of the simulation input
+    if (e.keysym.sym == SDLK_F5)
+    {
+        if (SaveSnapshot("quicksave.tds")) AddUiNotification("Game saved", 1.5f);
+        return;
+    }
+    if (e.keysym.sym == SDLK_F9)
+    {
+        if (m_IsRecording) AddUiNotification("Can't load while recording a replay", 1.5f);
+        else if (LoadSnapshot("quicksave.tds")) AddUiNotification("Game loaded", 1.5f);
+        return;
+    }
+    if (e.keysym.sym == SDLK_F3)
+    {
+        m_ShowDebugOverlay = !m_ShowDebugOverlay;
+        return;
+    }
+    if (e.keysym.sym == SDLK_F7)
+    {
+        m_pCircles->SetEnabled(!m_pCircles->IsEnabled());
+        return;
+    }
+    // Rewind one second while playing, or retry the current wave after losing
+    if ((e.keysym.sym == SDLK_BACKSPACE && m_GameState == GameState::Playing) ||
+        (e.keysym.sym == SDLK_r && m_GameState == GameState::GameOver))
+    {
+        if (m_IsRecording) AddUiNotification("Can't rewind while recording a replay", 1.5f);
+        else if (e.keysym.sym == SDLK_r) RewindToWaveStart();
+        else if (m_pRewindBuffer->GetCount() >= 2) RewindToEntry(m_pRewindBuffer->GetCount() - 2);
+        return;
+    }
+    if (m_IsRecording)
+        m_pReplay->AddEvent(ReplayEvent{ m_TickCount, ReplayEventType::KeyDown, e.keysym.sym, 0, 0, 0 });
+    HandleKeyDown(e.keysym.sym);
+}
+
+void Game::HandleKeyDown(SDL_Keycode key)
 {
     switch (m_GameState)
     {
     case GameState::UpgradeMenu:
-        switch (e.keysym.sym)
+        switch (key)
         {
         case SDLK_LEFT:
             m_SelectedUpgrade = (m_SelectedUpgrade - 1 + static_cast<int>(m_AvailableUpgrades.size())) % static_cast<int>(m_AvailableUpgrades.size());
@@ -493,9 +674,21 @@ void Game::ProcessKeyDownEvent(const SDL_KeyboardEvent& e)
             break;
         }
         break;
+    case GameState::Playing:
+        if (key == SDLK_t) {
+            m_pTower->CycleTargetingPolicy();
+            for (Tower* tower : m_Towers) tower->SetTargetingPolicy(m_pTower->GetTargetingPolicy());
+            AddNotification(std::string("TARGETING: ") + GetTargetingPolicyName(m_pTower->GetTargetingPolicy()), 1.5f);
+        }
+        else if (key == SDLK_h) {
+            bool enabled = !m_pTower->GetAnalyticHits();
+            for (Tower* tower : m_Towers) tower->SetAnalyticHits(enabled);
+            AddNotification(std::string("FAST SHOTS: ") + (enabled ? "RESOLVED ON FIRE" : "SIMULATED"), 1.5f);
+        }
+        break;
     case GameState::GameOver:
         // Handle quit keys in Game Over state
-        if (e.keysym.sym == SDLK_q || e.keysym.sym == SDLK_ESCAPE) {
+        if (key == SDLK_q || key == SDLK_ESCAPE) {
             m_bRunning = false;
         }
         // Don't handle restart in KeyDown, only in KeyUp to avoid multiple triggers
@@ -506,38 +699,18 @@ void Game::ProcessKeyDownEvent(const SDL_KeyboardEvent& e)
 }
 
 void Game::ProcessKeyUpEvent(const SDL_KeyboardEvent& e)
+{
+    if (m_IsPlayingBack) return;
+    if (m_IsRecording)
+        m_pReplay->AddEvent(ReplayEvent{ m_TickCount, ReplayEventType::KeyUp, e.keysym.sym, 0, 0, 0 });
+    HandleKeyUp(e.keysym.sym);
+}
+
+void Game::HandleKeyUp(SDL_Keycode key)
 {
     if (m_GameState == GameState::GameOver &&
-        (e.keysym.sym == SDLK_SPACE || e.keysym.sym == SDLK_RETURN)) {
-        // Clean up current game state
-        Cleanup();
-        // Reset all game state variables to initial values
-        m_CurrentWave = 1;
-        m_EnemiesKilled = 0;
-        m_EnemiesRequiredForWave = 5;
-        m_EnemiesSpawnedInWave = 0;
-        m_WaveInProgress = true;
-        m_BossSpawned = false;
-        m_IsBossWave = false;
-        m_BossWavesCompleted = 0;
-        m_EnemyDamageMultiplier = 1.0f;
-        m_EnemyAttackSpeedMultiplier = 1.0f;
-        m_EnemySpawnTimer = 0.f;
-        m_EnemySpawnInterval = 2.f;
-        m_RangedEnemyChance = 20;
-        m_MaxEnemies = 10;
-        // Reset tower health to initial values
-        m_TowerHealth = 100;
-        m_MaxTowerHealth = 100;
-        // Clear notifications
-        m_Notifications.clear();
-        m_NotificationTimer = -1.0f;
-        // Reset selected upgrade
-        m_SelectedUpgrade = 0;
-        // Reinitialize everything
-        Initialize();
-        // Set game state to playing
-        m_GameState = GameState::Playing;
+        (key == SDLK_SPACE || key == SDLK_RETURN)) {
+        RestartGame();
     }
 }
 
@@ -548,24 +721,32 @@ void Game::ProcessMouseMotionEvent(const SDL_MouseMotionEvent& e)
 
 void Game::ProcessMouseDownEvent(const SDL_MouseButtonEvent& e)
 {
-    if (m_GameState == GameState::UpgradeMenu)
+    if (m_IsPlayingBack) return;
+    if (m_IsRecording)
+        m_pReplay->AddEvent(ReplayEvent{ m_TickCount, ReplayEventType::MouseDown, e.button, e.x, e.y, e.clicks });
+    HandleMouseDown(e.x, e.y, e.clicks);
+}
+
+void Game::HandleMouseDown(int x, int y, int clicks)
+{
+    if (m_GameState == GameState::Playing)
+    {
+        PlaceTower(Vector2f{ float(x), float(y) });
+    }
+    else if (m_GameState == GameState::UpgradeMenu)
     {
-        float menuTop = m_Height / 2.f + 100.f;
-        float menuBottom = m_Height / 2.f - 100.f;
-        float menuWidth = 300.f;
-        float menuLeft = m_Width / 2.f - menuWidth / 2.f;
-        float itemHeight = 40.f;
-        if (e.x >= menuLeft && e.x <= menuLeft + menuWidth &&
-            e.y >= menuBottom && e.y <= menuTop)
+        for (size_t i = 0; i < m_AvailableUpgrades.size(); ++i)
         {
-            int clickedItem = static_cast<int>((menuTop - e.y) / itemHeight);
-            if (clickedItem >= 0 && clickedItem < static_cast<int>(m_AvailableUpgrades.size()))
+            Rectf card = GetUpgradeCardRect(i);
+            if (x >= card.left && x <= card.left + card.width &&
+                y >= card.bottom && y <= card.bottom + card.height)
             {
-                m_SelectedUpgrade = clickedItem;
-                if (e.clicks == 2)
+                m_SelectedUpgrade = static_cast<int>(i);
+                if (clicks == 2)
                 {
                     StartNextWave();
                 }
+                break;
             }
         }
     }
@@ -584,66 +765,14 @@ void Game::ClearBackground() const
 
 void Game::CleanupBullets()
 {
-    std::vector<Bullet>& bullets = m_pTower->GetBullets();
-    bullets.erase(
-        std::remove_if(bullets.begin(), bullets.end(),
-            [](const Bullet& b) { return !b.IsActive(); }),
-        bullets.end());
-}
-
-bool Game::ProcessBulletCollisions(EnemyBase* enemy)
-{
-    if (!enemy->IsAlive()) return false;
-    std::vector<Bullet>& bullets = m_pTower->GetBullets();
-    bool enemyWasKilled = false;
-    for (auto& bullet : bullets)
+    for (Tower* tower : m_Towers)
     {
-        if (!bullet.IsActive()) continue;
-        const auto& shape = enemy->GetShape();
-        if (bullet.CheckHit(shape))
-        {
-            enemy->TakeDamage(bullet.GetDamage());
-            bool enemyKilled = !enemy->IsAlive();
-            if (enemyKilled) {
-                enemyWasKilled = true;
-            }
-            bullet.TakeDamage();
-            if (bullet.IsActive() && bullet.GetHP() > 0)
-            {
-                EnemyBase* nextTarget = nullptr;
-                float minDist = std::numeric_limits<float>::max();
-                Vector2f bulletPos = bullet.GetPosition();
-                for (EnemyBase* other : m_pEnemies)
-                {
-                    if (other != enemy && other->IsAlive())
-                    {
-                        float dx = other->GetShape().center.x - bulletPos.x;
-                        float dy = other->GetShape().center.y - bulletPos.y;
-                        float dist = std::sqrt(dx * dx + dy * dy);
-                        if (dist < minDist && dist <= m_pTower->GetRange() * 1.2f)
-                        {
-                            minDist = dist;
-                            nextTarget = other;
-                        }
-                    }
-                }
-                if (nextTarget && nextTarget->IsAlive())
-                {
-                    Vector2f targetPos = nextTarget->GetShape().center;
-                    bullet.SetTarget(targetPos.x, targetPos.y);
-                }
-                else
-                {
-                    bullet.Deactivate();
-                }
-            }
-            else
-            {
-                bullet.Deactivate();
-            }
-        }
+        std::vector<Bullet>& bullets = tower->GetBullets();
+        bullets.erase(
+            std::remove_if(bullets.begin(), bullets.end(),
+                [](const Bullet& b) { return !b.IsActive(); }),
+            bullets.end());
     }
-    return enemyWasKilled;
 }
 
 void Game::DrawUpgradeMenu() const
@@ -655,58 +784,55 @@ void Game::DrawUpgradeMenu() const
     titleText.Draw(Vector2f(m_Width / 2.f - titleText.GetWidth() / 2.f, m_Height / 2.f + 200.f));
     Texture chooseText("Choose an upgrade:", m_MainFontPath, m_NormalFontSize, m_NormalColor);
     chooseText.Draw(Vector2f(m_Width / 2.f - chooseText.GetWidth() / 2.f, m_Height / 2.f + 150.f));
-    float cardWidth = 180.f;
-    float cardHeight = 240.f;
-    float descriptionPadding = 10.f;
-    float slotPadding = 10.f;
-    float totalWidth = m_AvailableUpgrades.size() * (cardWidth + slotPadding) - slotPadding;
-    float menuLeft = m_Width / 2.f - totalWidth / 2.f;
-    float menuMiddle = m_Height / 2.f;
+    const float slotPadding = 10.f;
     for (size_t i = 0; i < m_AvailableUpgrades.size(); ++i)
     {
-        float cardX = menuLeft + i * (cardWidth + slotPadding);
-        float cardY = menuMiddle - cardHeight / 2.f;
-        float slotX = cardX - slotPadding;
-        float slotY = cardY - slotPadding;
-        float slotW = cardWidth + 2 * slotPadding;
-        float slotH = cardHeight + 2 * slotPadding;
-        if (i == m_SelectedUpgrade)
+        Rectf card = GetUpgradeCardRect(i);
+        bool selected = static_cast<int>(i) == m_SelectedUpgrade;
+        if (selected)
             utils::SetColor(Color4f(1.0f, 0.9f, 0.3f, 0.5f));
         else
             utils::SetColor(Color4f(0.2f, 0.2f, 0.2f, 0.3f));
-        utils::FillRect(Rectf(slotX, slotY, slotW, slotH));
-        m_AvailableUpgrades[i]->Draw(cardX, cardY, cardWidth, cardHeight, i == m_SelectedUpgrade);
+        utils::FillRect(Rectf(card.left - slotPadding, card.bottom - slotPadding,
+            card.width + 2 * slotPadding, card.height + 2 * slotPadding));
+        m_AvailableUpgrades[i]->Draw(card.left, card.bottom, card.width, card.height, selected);
     }
-    float instructionY = menuMiddle - cardHeight / 2.f - 70.f;
+    float gridBottom = m_AvailableUpgrades.empty() ? m_Height / 2.f : GetUpgradeCardRect(m_AvailableUpgrades.size() - 1).bottom;
+    float instructionY = std::max(20.f, gridBottom - 70.f);
     utils::SetColor(Color4f(1.0f, 1.0f, 1.0f, 0.7f));
     Texture instr1("Use LEFT/RIGHT arrows and ENTER to select", m_MainFontPath, m_SmallFontSize, m_NormalColor);
     instr1.Draw(Vector2f(m_Width / 2.f - instr1.GetWidth() / 2.f, instructionY));
 }
 
-bool Game::ProcessEnemyAttacks(float elapsedSec)
+Rectf Game::GetUpgradeCardRect(size_t index) const
 {
-    bool towerDamaged = false;
-    Rectf towerRect = m_pTower->GetPosition();
-    for (EnemyBase* enemy : m_pEnemies)
-    {
-        if (enemy->GetType() == EnemyType::Melee)
-        {
-            MeleeEnemy* melee = static_cast<MeleeEnemy*>(enemy);
-            if (melee->m_AtTower && melee->m_AttackCooldown <= 0.0f)
-            {
-                int damage = melee->GetAttackDamage();
-                UpdateTowerHealth(-damage);
-                melee->m_AttackCooldown = 1.0f;
-                towerDamaged = true;
-            }
-        }
-    }
-    return towerDamaged;
+    // Cards wrap into centred rows once they no longer fit side by side and
+    // get shorter so every row stays between the heading and the instructions.
+    // They are as wide as the longest upgrade name
+    const float slotPadding = 10.f;
+    const float cardWidth = 200.f;
+    const float rowGap = 3 * slotPadding;
+    const size_t cardCount = m_AvailableUpgrades.size();
+    const size_t maxColumns = std::max<size_t>(1, static_cast<size_t>((m_Width - 40.f + slotPadding) / (cardWidth + slotPadding)));
+    const size_t rows = (cardCount + maxColumns - 1) / maxColumns;
+    const size_t columns = (cardCount + rows - 1) / rows;
+    float menuMiddle = m_Height / 2.f;
+    float menuTop = menuMiddle + 130.f;
+    float menuBottom = 70.f;
+    float cardHeight = std::min(240.f, (menuTop - menuBottom - (rows - 1) * rowGap) / rows);
+    float gridHeight = rows * cardHeight + (rows - 1) * rowGap;
+    float gridTop = std::min(menuMiddle + gridHeight / 2.f, menuTop);
+
+    size_t row = index / columns;
+    size_t rowCount = std::min(columns, cardCount - row * columns);
+    float rowWidth = rowCount * (cardWidth + slotPadding) - slotPadding;
+    float cardX = m_Width / 2.f - rowWidth / 2.f + (index % columns) * (cardWidth + slotPadding);
+    float cardY = gridTop - (row + 1) * cardHeight - row * rowGap;
+    return Rectf(cardX, cardY, cardWidth, cardHeight);
 }
 
 void Game::StartNextWave()
 {
-    m_BossSpawned = false;
     if (m_GameState == GameState::UpgradeMenu && !m_AvailableUpgrades.empty()) {
         if (m_SelectedUpgrade < m_AvailableUpgrades.size()) {
             Upgrade* selected = m_AvailableUpgrades[m_SelectedUpgrade];
@@ -715,11 +841,9 @@ void Game::StartNextWave()
                 m_TowerHealth += static_cast<int>(selected->GetAmount());
             }
             else {
-                selected->Apply(*m_pTower);
+                for (Tower* tower : m_Towers) selected->Apply(*tower);
             }
         }
-        for (Upgrade* upgrade : m_AvailableUpgrades) delete upgrade;
-        m_AvailableUpgrades.clear();
     }
     bool currentWaveWasBoss = (m_CurrentWave % 5 == 0);
     if (currentWaveWasBoss) {
@@ -729,19 +853,21 @@ void Game::StartNextWave()
     bool nextWaveBossWave = ((m_CurrentWave + 1) % 5 == 0);
     if (nextWaveBossWave) {
         AddNotification("WARNING: BOSS WAVE INCOMING!", 2.5f);
-        m_EnemiesRequiredForWave = 1;
+        // A horde boss wave brings one more boss every five waves
+        m_EnemiesRequiredForWave = m_HordeMode ? (m_CurrentWave + 1) / 5 : 1;
     }
     else {
-        m_EnemiesRequiredForWave = 5 + (m_CurrentWave * 2);
+        m_EnemiesRequiredForWave = (5 + (m_CurrentWave * 2)) * (m_HordeMode ? g_HordeWaveScale : 1);
     }
     m_CurrentWave++;
+    m_TowerCharges++;
     m_EnemiesKilled = 0;
     m_EnemiesSpawnedInWave = 0;
     m_WaveInProgress = true;
     m_EnemySpawnInterval = std::max(0.5f, 2.0f - (m_CurrentWave * 0.1f));
+    m_pScripts->Start(ScriptType::Wave, 0);
     m_RangedEnemyChance = std::min(40, 20 + m_CurrentWave);
-    for (EnemyBase* enemy : m_pEnemies) delete enemy;
-    m_pEnemies.clear();
+    m_pEnemyWorld->Clear();
     m_GameState = GameState::Playing;
 }
 
@@ -755,7 +881,7 @@ void Game::ApplyPostBossWaveUpgrades()
     int healthBonus = static_cast<int>(m_MaxTowerHealth * 0.1f);
     m_MaxTowerHealth += healthBonus;
     m_TowerHealth += healthBonus;
-    m_pTower->IncreaseDamage(m_pTower->GetDamage() * 0.05f);
+    for (Tower* tower : m_Towers) tower->IncreaseDamage(tower->GetDamage() * 0.05f);
 }
 
 void Game::GameOver() const
@@ -776,44 +902,143 @@ void Game::GameOver() const
     // --- NEW: Draw quit instruction ---
     Texture quitText("Press Q or ESC to quit", m_MainFontPath, m_NormalFontSize, m_NormalColor);
     quitText.Draw(Vector2f(m_Width / 2 - quitText.GetWidth() / 2, m_Height / 2 - 80));
+    if (m_pRewindBuffer->FindWaveStart(m_CurrentWave) >= 0 && !m_IsRecording) {
+        Texture retryText("Press R to retry this wave", m_MainFontPath, m_NormalFontSize, m_HighlightColor);
+        retryText.Draw(Vector2f(m_Width / 2 - retryText.GetWidth() / 2, m_Height / 2 - 140));
+    }
 }
 
 void Game::RestartGame()
 {
-    m_TowerHealth = m_MaxTowerHealth = 100;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Only simulation state is reset; textures, fonts and upgrade cards stay loaded
+    m_pEnemyWorld->Reset();
+    ClearPlacedTowers();
+    m_TowerCharges = 1;
+    m_pTower->ResetToInitialStats();
+    m_pTower->ClearBullets();
     m_CurrentWave = 1;
     m_EnemiesKilled = 0;
-    m_Score = 0;
+    m_EnemiesRequiredForWave = 5 * (m_HordeMode ? g_HordeWaveScale : 1);
+    m_EnemiesSpawnedInWave = 0;
+    m_WaveInProgress = true;
+    m_IsBossWave = false;
+    m_BossWavesCompleted = 0;
     m_EnemyDamageMultiplier = 1.0f;
     m_EnemyAttackSpeedMultiplier = 1.0f;
-    m_BossWavesCompleted = 0;
-    for (EnemyBase* enemy : m_pEnemies) {
-        delete enemy;
-    }
-    m_pEnemies.clear();
-    if (m_pTower) {
-        m_pTower->ResetToInitialStats();
-        m_pTower->ClearBullets();
-    }
-    for (Upgrade* upgrade : m_AvailableUpgrades) {
-        delete upgrade;
-    }
-    m_AvailableUpgrades.clear();
-    m_SelectedUpgrade = 0;
-    m_WaveInProgress = true;
-    m_EnemiesSpawnedInWave = 0;
-    m_EnemiesRequiredForWave = 5 + (m_CurrentWave * 2);
-    m_EnemySpawnInterval = 2.0f;
+    m_EnemySpawnInterval = 2.f;
     m_RangedEnemyChance = 20;
+    m_MaxEnemies = m_HordeMode ? g_HordeMaxEnemies : 10;
+    m_TowerHealth = 100;
+    m_MaxTowerHealth = 100;
+    m_Score = 0;
     m_Notifications.clear();
+    m_NotificationTimer = -1.0f;
+    m_SelectedUpgrade = 0;
+    // Enemy handles start over, so no old timer or script may fire into the new run
+    m_pTimers->Clear();
+    m_pScripts->StopAll();
+    m_pScripts->Start(ScriptType::Wave, 0);
+    m_pAreaDamage->Clear();
+    m_pParticles->Clear();
+    // A new run starts a new rewind history
+    m_pRewindBuffer->Clear();
+    m_LastRewindWave = 0;
     m_GameState = GameState::Playing;
-    SetupUpgradeOptions();
-    StartNextWave();
+
+    m_RestartMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
 }
 
 void Game::AddNotification(const std::string& text, float duration)
 {
-    m_Notifications.push_back(std::make_pair(text, duration));
+    uint32_t expiryTick = m_pTimers->GetTick() + TimingWheel::ToTicks(duration, m_TickDuration);
+    m_Notifications.push_back(std::make_pair(text, expiryTick));
+    m_pTimers->Schedule(expiryTick, TimerKind::NotificationExpiry, 0);
+}
+
+void Game::AddUiNotification(const std::string& text, float duration)
+{
+    m_UiNotifications.push_back(std::make_pair(text, duration));
+}
+
+void Game::ExpireNotifications()
+{
+    uint32_t tick = m_pTimers->GetTick();
+    m_Notifications.erase(
+        std::remove_if(m_Notifications.begin(), m_Notifications.end(),
+            [tick](const std::pair<std::string, uint32_t>& notification) { return notification.second <= tick; }),
+        m_Notifications.end());
+}
+
+void Game::DrawNotification(const std::string& text, float remaining, float y) const
+{
+    float alpha = 1.0f;
+    if (remaining < 1.0f) {
+        alpha = remaining;
+    }
+    else if (text.find("WARNING") != std::string::npos) {
+        alpha = 0.7f + 0.3f * sin(SDL_GetTicks() * 0.008f);
+    }
+    Color4f notifColor;
+    if (text.find("WARNING") != std::string::npos) {
+        notifColor = Color4f(1.0f, 0.2f, 0.2f, alpha);
+    }
+    else if (text.find("LEVEL") != std::string::npos) {
+        notifColor = Color4f(1.0f, 0.7f, 0.2f, alpha);
+    }
+    else {
+        notifColor = Color4f(1.0f, 1.0f, 1.0f, alpha);
+    }
+    Texture notifText(text, m_HeaderFontPath, m_NormalFontSize, notifColor);
+    notifText.Draw(Vector2f(m_Width / 2.f - notifText.GetWidth() / 2.f, y));
+}
+
+ScriptAwait Game::ResumeWaveScript(ScriptFrame& frame)
+{
+    const uint32_t interval = TimingWheel::ToTicks(m_EnemySpawnInterval, m_TickDuration);
+    switch (frame.step)
+    {
+    case WaveStart:
+        frame.step = WaveSpawn;
+        return ScriptAwait::Delay(interval);
+    case WaveSpawn:
+        // A full field frees up when something dies
+        if (m_pEnemyWorld->GetCount() >= static_cast<size_t>(m_MaxEnemies)) return ScriptAwait::Event(ScriptEvent::EnemyKilled);
+        SpawnNextEnemy();
+        // The rest of a horde batch, as far as the wave and the field allow
+        for (int i = 1; m_HordeMode && i < g_HordeSpawnBatch && m_EnemiesSpawnedInWave < m_EnemiesRequiredForWave &&
+            m_pEnemyWorld->GetCount() < static_cast<size_t>(m_MaxEnemies); ++i)
+        {
+            SpawnNextEnemy();
+        }
+        if (m_EnemiesSpawnedInWave < m_EnemiesRequiredForWave) return ScriptAwait::Delay(interval);
+        frame.step = WaveClear;
+        return ScriptAwait::Event(ScriptEvent::EnemyKilled);
+    default:
+        if (m_GameState == GameState::Playing && m_EnemiesKilled >= m_EnemiesRequiredForWave && m_pEnemyWorld->IsEmpty())
+        {
+            CompleteWave();
+            return ScriptAwait::Done();
+        }
+        return ScriptAwait::Event(ScriptEvent::EnemyKilled);
+    }
+}
+
+void Game::SpawnNextEnemy()
+{
+    m_EnemiesSpawnedInWave++;
+    if (m_IsBossWave)
+    {
+        SpawnEnemy(EnemySpawnType::Boss);
+    }
+    else
+    {
+        EnemySpawnType type = (Random::NextInt(100) < m_RangedEnemyChance)
+            ? EnemySpawnType::Ranged
+            : EnemySpawnType::Normal;
+        SpawnEnemy(type);
+    }
 }
 
 void Game::InitializeFonts()
@@ -865,26 +1090,94 @@ void Game::UpdateTowerHealth(int amount)
         m_TowerHealth = 0;
 }
 
-void Game::CheckWaveComplete()
+bool Game::PlaceTower(const Vector2f& center)
 {
-    if (!m_WaveInProgress || m_GameState != GameState::Playing)
-        return;
-    bool allEnemiesSpawned = (m_EnemiesSpawnedInWave >= m_EnemiesRequiredForWave);
-    bool allEnemiesKilled = (m_EnemiesKilled >= m_EnemiesRequiredForWave);
-    bool noEnemiesLeft = m_pEnemies.empty();
-    if (allEnemiesSpawned && allEnemiesKilled && noEnemiesLeft)
-    {
-        int healAmount = 20;
-        m_TowerHealth += healAmount;
-        if (m_TowerHealth > m_MaxTowerHealth)
-            m_TowerHealth = m_MaxTowerHealth;
-        AddNotification("Healed " + std::to_string(healAmount) + " health!", 2.0f);
-        m_WaveInProgress = false;
-        m_GameState = GameState::UpgradeMenu;
-        m_SelectedUpgrade = 0;
-        SetupUpgradeOptions();
-        AddNotification("Wave " + std::to_string(m_CurrentWave) + " completed!", 2.0f);
+    if (m_TowerCharges <= 0) {
+        AddNotification("No towers left to place", 1.5f);
+        return false;
     }
+    const float minSpacing = 50.f;
+    if (center.x < 0.f || center.x > m_Width || center.y < 0.f || center.y > m_Height)
+        return false;
+    for (const Tower* tower : m_Towers) {
+        Vector2f other = tower->GetCenter();
+        float dx = other.x - center.x;
+        float dy = other.y - center.y;
+        if (dx * dx + dy * dy <= minSpacing * minSpacing) {
+            AddNotification("Too close to another tower", 1.5f);
+            return false;
+        }
+    }
+    AddTower(center);
+    --m_TowerCharges;
+    return true;
+}
+
+void Game::AddTower(const Vector2f& center)
+{
+    const float towerWidth = 30.f;
+    const float towerHeight = 45.f;
+    Tower* pTower{ new Tower{ Rectf{ center.x - towerWidth / 2.f, center.y - towerHeight / 2.f, towerWidth, towerHeight }, 150.f } };
+    pTower->CopyUpgradesFrom(*m_pTower);
+    m_Towers.push_back(pTower);
+    m_TowerIndexDirty = true;
+}
+
+void Game::UpdateTowers(float elapsedSec)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (m_Towers.size() >= g_MinParallelTowers)
+    {
+        m_pWorkerPool->ParallelFor(m_Towers.size(), [this, elapsedSec](size_t i) {
+            m_Towers[i]->Update(elapsedSec, *m_pEnemyWorld, *m_pEnemyGrid, m_Width, m_Height);
+        });
+    }
+    else
+    {
+        for (Tower* tower : m_Towers)
+            tower->Update(elapsedSec, *m_pEnemyWorld, *m_pEnemyGrid, m_Width, m_Height);
+    }
+    m_TowerUpdateMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Game::DamagePlacedTowers()
+{
+    // Index 0 is the main tower, whose health is the game's own m_TowerHealth
+    size_t kept = 1;
+    for (size_t i = 1; i < m_Towers.size(); ++i)
+    {
+        m_Towers[i]->TakeDamage(m_TowerDamage[i]);
+        if (m_Towers[i]->IsDestroyed()) {
+            delete m_Towers[i];
+            AddNotification("A tower was destroyed!", 2.0f);
+            m_TowerIndexDirty = true;
+            continue;
+        }
+        m_Towers[kept++] = m_Towers[i];
+    }
+    m_Towers.resize(kept);
+}
+
+void Game::ClearPlacedTowers()
+{
+    for (size_t i = 1; i < m_Towers.size(); ++i)
+        delete m_Towers[i];
+    m_Towers.resize(std::min<size_t>(m_Towers.size(), 1));
+    m_TowerIndexDirty = true;
+}
+
+void Game::CompleteWave()
+{
+    int healAmount = 20;
+    m_TowerHealth += healAmount;
+    if (m_TowerHealth > m_MaxTowerHealth)
+        m_TowerHealth = m_MaxTowerHealth;
+    AddNotification("Healed " + std::to_string(healAmount) + " health!", 2.0f);
+    m_WaveInProgress = false;
+    m_GameState = GameState::UpgradeMenu;
+    m_SelectedUpgrade = 0;
+    SetupUpgradeOptions();
+    AddNotification("Wave " + std::to_string(m_CurrentWave) + " completed!", 2.0f);
 }
 
 void Game::OnWindowResize(float newWidth, float newHeight)
@@ -898,5 +1191,610 @@ void Game::OnWindowResize(float newWidth, float newHeight)
         float centerX = m_Width / 2.f - towerWidth / 2.f;
         float centerY = m_Height / 2.f - towerHeight / 2.f + 75.0f;
         m_pTower->SetPosition(Rectf{ centerX, centerY, towerWidth, towerHeight });
+        m_TowerIndexDirty = true;
+    }
+}
+
+
+void Game::StartRecording(const std::string& path)
+{
+    if (!m_pReplay) m_pReplay = new Replay{};
+
+    // Restart the generator from its seed so the replay starts from a known state
+    Random::Seed(Random::GetSeed());
+    m_pReplay->Reset(Random::GetSeed(), m_TickRate, m_Width, m_Height);
+    m_ReplayPath = path;
+    m_TickCount = 0;
+    m_TickAccumulator = 0.f;
+
+    // The replay starts from the current state, which may be a loaded snapshot
+    std::vector<uint8_t> initialState;
+    WriteSnapshot(initialState);
+    m_pReplay->SetInitialState(initialState);
+    m_IsRecording = true;
+    m_IsPlayingBack = false;
+}
+
+void Game::StartPlayback(const Replay& replay)
+{
+    if (!m_pReplay) m_pReplay = new Replay{};
+    *m_pReplay = replay;
+
+    Random::Seed(replay.GetSeed());
+    if (!replay.GetInitialState().empty() && !ReadSnapshot(replay.GetInitialState()))
+    {
+        std::cerr << "Replay contains an invalid initial state, playing from a fresh game" << std::endl;
+    }
+    m_TickRate = replay.GetTickRate();
+    m_TickDuration = 1.f / m_TickRate;
+    m_TickCount = 0;
+    m_TickAccumulator = 0.f;
+    m_ReplayEventIndex = 0;
+    m_PlaybackSeconds = 0.f;
+    m_IsRecording = false;
+    m_IsPlayingBack = true;
+}
+
+bool Game::IsPlaybackFinished() const
+{
+    return m_IsPlayingBack && m_TickCount >= m_pReplay->GetTickCount();
+}
+
+void Game::RunHeadless()
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (m_bRunning && !IsPlaybackFinished())
+    {
+        StepSimulation();
     }
+    PrintPlaybackStats(std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count());
+}
+
+void Game::RunBenchmark(int enemyCount, int ticks, int towerCount)
+{
+    PrepareBenchmark(enemyCount, towerCount);
+    std::vector<double> systemMicroseconds;
+    double towerMicroseconds = 0.0;
+    double totalMicroseconds = MeasureBenchmark(ticks, systemMicroseconds, towerMicroseconds);
+
+    double perTick = totalMicroseconds / ticks;
+    std::cout << "Benchmark: " << enemyCount << " enemies, " << m_Towers.size() << " towers, " << ticks << " ticks, "
+        << m_pEnemyWorld->GetCount() << " alive at the end" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << "  update: " << perTick << " us/tick, "
+        << perTick * 10000.0 / enemyCount << " us/tick per 10k enemies" << std::endl;
+    const std::vector<SystemScheduler::System>& systems = m_pScheduler->GetSystems();
+    for (size_t i = 0; i < systems.size(); ++i)
+        std::cout << "  " << systems[i].name << ": " << systemMicroseconds[i] / ticks << " us/tick" << std::endl;
+    std::cout << "  Towers (" << m_pWorkerPool->GetThreadCount() + 1 << " threads): " << towerMicroseconds / ticks << " us/tick" << std::endl;
+}
+
+void Game::RunScalingBenchmark(int maxEnemies, int ticks)
+{
+    std::cout << "Scaling benchmark: " << ticks << " ticks per run, cost per enemy per tick" << std::endl;
+    for (int divisor : { 8, 4, 2, 1 })
+    {
+        int enemyCount = std::max(1, maxEnemies / divisor);
+        RestartGame();
+        PrepareBenchmark(enemyCount, 0);
+        std::vector<double> systemMicroseconds;
+        double towerMicroseconds = 0.0;
+        double totalMicroseconds = MeasureBenchmark(ticks, systemMicroseconds, towerMicroseconds);
+
+        double toNanoseconds = 1000.0 / (double(ticks) * enemyCount);
+        std::cout << std::fixed << std::setprecision(1)
+            << "  " << enemyCount << " enemies: " << totalMicroseconds * toNanoseconds << " ns total";
+        const std::vector<SystemScheduler::System>& systems = m_pScheduler->GetSystems();
+        for (size_t i = 0; i < systems.size(); ++i)
+            std::cout << ", " << systems[i].name << " " << systemMicroseconds[i] * toNanoseconds;
+        std::cout << std::endl;
+    }
+}
+
+void Game::PrepareBenchmark(int enemyCount, int towerCount)
+{
+    // Extra towers on an even grid over the field
+    int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(float(towerCount)))));
+    int rows = std::max(1, (towerCount + columns - 1) / columns);
+    for (int i = 0; i < towerCount; ++i)
+    {
+        Vector2f center{ (i % columns + 0.5f) * m_Width / columns, (i / columns + 0.5f) * m_Height / rows };
+        AddTower(center);
+        m_Towers.back()->UpgradeMaxHealth(float(std::numeric_limits<int>::max() / 2));
+    }
+
+    // Keep the tower alive and the wave open so every tick measures the full horde
+    m_MaxEnemies = enemyCount;
+    m_EnemiesRequiredForWave = std::numeric_limits<int>::max();
+    m_EnemySpawnInterval = std::numeric_limits<float>::max();
+    // No wave script, so nothing spawns beyond the horde
+    m_pScripts->StopAll();
+    m_MaxTowerHealth = std::numeric_limits<int>::max();
+    m_TowerHealth = m_MaxTowerHealth;
+    for (int i = 0; i < enemyCount; ++i)
+        SpawnEnemy(i % 5 == 0 ? EnemySpawnType::Ranged : EnemySpawnType::Normal);
+}
+
+double Game::MeasureBenchmark(int ticks, std::vector<double>& systemMicroseconds, double& towerMicroseconds)
+{
+    systemMicroseconds.assign(m_pScheduler->GetSystems().size(), 0.0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < ticks; ++tick)
+    {
+        UpdateSimulation(m_TickDuration);
+        const std::vector<SystemScheduler::System>& systems = m_pScheduler->GetSystems();
+        for (size_t i = 0; i < systems.size(); ++i)
+            systemMicroseconds[i] += systems[i].lastMicroseconds;
+        towerMicroseconds += m_TowerUpdateMicroseconds;
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Game::LoadScenario(const Scenario& scenario)
+{
+    RestartGame();
+    m_CurrentWave = scenario.wave;
+    PrepareBenchmark(0, scenario.towers);
+    for (Tower* tower : m_Towers)
+    {
+        tower->UpgradeRicochet(scenario.ricochet);
+        tower->UpgradeAttackSpeed(scenario.attackSpeed);
+    }
+
+    // Bosses first, so a ring scenario's bosses start on the innermost ring
+    const Vector2f center = m_pTower->GetCenter();
+    const float innerRadius = std::min(m_Width, m_Height) * 0.4f;
+    const int total = scenario.bosses + scenario.ranged + scenario.melee;
+    const int perRing = std::max(1, (total + g_ScenarioRingCount - 1) / g_ScenarioRingCount);
+    m_MaxEnemies = total;
+    for (int i = 0; i < total; ++i)
+    {
+        EnemySpawnType type = EnemySpawnType::Normal;
+        if (i < scenario.bosses) type = EnemySpawnType::Boss;
+        else if (i < scenario.bosses + scenario.ranged) type = EnemySpawnType::Ranged;
+
+        if (scenario.layout == ScenarioLayout::Edges)
+        {
+            SpawnEnemy(type);
+            continue;
+        }
+        int ring = i / perRing;
+        float angle = g_TwoPi * (i % perRing) / perRing + ring * 0.5f;
+        float radius = innerRadius + ring * g_ScenarioRingSpacing;
+        SpawnEnemy(type, Vector2f{ center.x + std::cos(angle) * radius, center.y + std::sin(angle) * radius });
+    }
+
+    // Slow bullets converging on the main tower from anywhere within the inner ring
+    ProjectileStore& projectiles = m_pEnemyWorld->GetProjectiles();
+    for (int i = 0; i < scenario.projectiles; ++i)
+    {
+        float angle = Random::NextFloat() * g_TwoPi;
+        float distance = 100.f + Random::NextFloat() * (innerRadius - 100.f);
+        float speed = 20.f + Random::NextFloat() * 40.f;
+        Vector2f position{ center.x + std::cos(angle) * distance, center.y + std::sin(angle) * distance };
+        projectiles.EmitTowards(position, center, speed, 1);
+    }
+
+    AddNotification(std::string("SCENARIO: ") + scenario.description, 3.f);
+    m_pScenario = &scenario;
+    m_ScenarioTimings = ScenarioTimings{};
+    m_ScenarioTimings.systems.assign(m_pScheduler->GetSystems().size(), 0.0);
+    std::cout << "Loaded scenario " << scenario.name << ": " << m_pEnemyWorld->GetCount() << " enemies, "
+        << projectiles.Size() << " bullets, " << m_Towers.size() << " towers" << std::endl;
+}
+
+void Game::RunScenario()
+{
+    while (m_bRunning && m_pScenario)
+    {
+        // Particles still age once per tick, with nothing drawn
+        m_pParticles->Update(m_TickDuration);
+        m_ScenarioTimings.particles += m_pParticles->GetLastUpdateMicroseconds();
+        ++m_ScenarioTimings.frames;
+        StepSimulation();
+    }
+}
+
+void Game::StartHordeMode()
+{
+    m_HordeMode = true;
+    RestartGame();
+    AddNotification("HORDE MODE", 3.f);
+}
+
+void Game::AddScenarioTick()
+{
+    const std::vector<SystemScheduler::System>& systems = m_pScheduler->GetSystems();
+    for (size_t i = 0; i < systems.size(); ++i)
+        m_ScenarioTimings.systems[i] += systems[i].lastMicroseconds;
+    m_ScenarioTimings.timers += m_TimerUpdateMicroseconds;
+    m_ScenarioTimings.towers += m_TowerUpdateMicroseconds;
+    m_ScenarioTimings.cleanup += m_CleanupMicroseconds;
+    if (++m_ScenarioTimings.ticks < m_pScenario->ticks) return;
+
+    PrintScenarioTimings();
+    m_pScenario = nullptr;
+}
+
+void Game::PrintScenarioTimings() const
+{
+    const ScenarioTimings& timings = m_ScenarioTimings;
+    const double ticks = std::max(1, timings.ticks);
+    const double frames = std::max(1, timings.frames);
+    double simulation = timings.timers + timings.towers + timings.cleanup;
+    for (double system : timings.systems) simulation += system;
+
+    std::cout << "Scenario " << m_pScenario->name << " (" << m_pScenario->description << "): " << timings.ticks << " ticks, "
+        << m_pEnemyWorld->GetCount() << " enemies and " << m_pEnemyWorld->GetProjectiles().Size() << " bullets left" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+        << "  simulation: " << simulation / ticks << " us/tick" << std::endl
+        << "  Timers and scripts: " << timings.timers / ticks << " us/tick" << std::endl;
+    const std::vector<SystemScheduler::System>& systems = m_pScheduler->GetSystems();
+    for (size_t i = 0; i < systems.size(); ++i)
+        std::cout << "  " << systems[i].name << ": " << timings.systems[i] / ticks << " us/tick" << std::endl;
+    std::cout << "  Towers: " << timings.towers / ticks << " us/tick" << std::endl
+        << "  Dead enemies and waves: " << timings.cleanup / ticks << " us/tick" << std::endl
+        << "  Particles: " << timings.particles / frames << " us/frame" << std::endl;
+    // Headless runs never draw
+    if (timings.draw > 0.0)
+        std::cout << "  Draw: " << timings.draw / frames << " us/frame over " << timings.frames << " frames" << std::endl;
+}
+
+void Game::DispatchReplayEvents()
+{
+    const std::vector<ReplayEvent>& events = m_pReplay->GetEvents();
+    while (m_ReplayEventIndex < events.size() && events[m_ReplayEventIndex].tick <= m_TickCount)
+    {
+        const ReplayEvent& event = events[m_ReplayEventIndex++];
+        switch (event.type)
+        {
+        case ReplayEventType::KeyDown:
+            HandleKeyDown(event.code);
+            break;
+        case ReplayEventType::KeyUp:
+            HandleKeyUp(event.code);
+            break;
+        case ReplayEventType::MouseDown:
+            HandleMouseDown(event.x, event.y, event.clicks);
+            break;
+        }
+    }
+}
+
+void Game::PrintPlaybackStats(float seconds) const
+{
+    std::cout << "Replay finished: " << m_TickCount << " ticks, wave " << m_CurrentWave;
+    if (seconds > 0.f)
+    {
+        std::cout << ", " << std::fixed << std::setprecision(3) << seconds << " s ("
+            << std::setprecision(0) << m_TickCount / seconds << " ticks/s)";
+    }
+    std::cout << std::endl;
+}
+
+void Game::StartHashLog(const std::string& path)
+{
+    delete m_pHashLog;
+    m_pHashLog = new StateHashLog{};
+    if (!m_pHashLog->Open(path))
+    {
+        delete m_pHashLog;
+        m_pHashLog = nullptr;
+    }
+}
+
+uint64_t Game::ComputeStateHash() const
+{
+    std::vector<uint8_t> state;
+    SnapshotWriter writer{ state };
+    WriteState(writer);
+
+    StateHash hash;
+    hash.AddBytes(state.data(), state.size());
+    return hash.GetValue();
+}
+
+bool Game::SaveSnapshot(const std::string& path) const
+{
+    std::vector<uint8_t> buffer;
+    WriteSnapshot(buffer);
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile.is_open())
+    {
+        std::cout << "Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    std::cout << "Saved snapshot (" << buffer.size() << " bytes) to " << path << std::endl;
+    return outFile.good();
+}
+
+bool Game::LoadSnapshot(const std::string& path)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // One read of the whole file, then parse from memory
+    std::ifstream inFile(path, std::ios::binary | std::ios::ate);
+    if (!inFile.is_open())
+    {
+        std::cout << "Could not open " << path << " for reading" << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> buffer(static_cast<size_t>(inFile.tellg()));
+    inFile.seekg(0);
+    inFile.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+
+    if (!inFile || !ReadSnapshot(buffer))
+    {
+        std::cout << "Invalid snapshot file: " << path << std::endl;
+        return false;
+    }
+
+    float microseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Loaded snapshot " << path << " (wave " << m_CurrentWave << ", " << m_pEnemyWorld->GetCount()
+        << " enemies) in " << std::fixed << std::setprecision(1) << microseconds << " us" << std::endl;
+    return true;
+}
+
+bool Game::RewindToEntry(size_t index)
+{
+    std::vector<uint8_t> buffer;
+    if (!m_pRewindBuffer->Restore(index, buffer) || !ReadSnapshot(buffer))
+    {
+        AddNotification("Rewind failed", 1.5f);
+        return false;
+    }
+    // Play continues from here, so the entries after it belong to a discarded future
+    m_pRewindBuffer->TruncateAfter(index);
+    m_LastRewindWave = m_CurrentWave;
+    m_TickAccumulator = 0.f;
+    return true;
+}
+
+bool Game::RewindToWaveStart()
+{
+    int index = m_pRewindBuffer->FindWaveStart(m_CurrentWave);
+    if (index < 0)
+    {
+        AddNotification("Wave start is no longer in the rewind buffer", 1.5f);
+        return false;
+    }
+    if (!RewindToEntry(static_cast<size_t>(index))) return false;
+    AddNotification("Retrying wave " + std::to_string(m_CurrentWave), 1.5f);
+    return true;
+}
+
+void Game::CaptureRewindPoint()
+{
+    std::vector<uint8_t> buffer;
+    WriteSnapshot(buffer);
+    bool isWaveStart = m_CurrentWave != m_LastRewindWave;
+    m_pRewindBuffer->Push(buffer, m_CurrentWave, isWaveStart);
+    m_LastRewindWave = m_CurrentWave;
+}
+
+void Game::DrawDebugOverlay() const
+{
+    std::vector<std::string> lines;
+    std::ostringstream oss;
+    oss << "TICK: " << m_TickCount << "  ENEMIES: " << m_pEnemyWorld->GetCount();
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "REWIND: " << m_pRewindBuffer->GetCount() << " entries  LAST RESTART: " << std::fixed << std::setprecision(1)
+        << m_RestartMicroseconds << " us";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "MEMORY: " << m_pRewindBuffer->GetStoredBytes() / 1024 << " / "
+        << m_pRewindBuffer->GetMemoryBudget() / 1024 << " KB";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "COMPRESSION: " << std::fixed << std::setprecision(1) << m_pRewindBuffer->GetCompressionRatio()
+        << " : 1 (" << m_pRewindBuffer->GetRawBytes() / 1024 << " KB raw)";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "TARGETING: " << m_pTower->GetTargetQueryCount() << " queries, "
+        << m_pTower->GetCachedShotCount() << " cached shots";
+    lines.push_back(oss.str());
+    for (int i = 0; i < static_cast<int>(TargetingPolicy::Count); ++i) {
+        TargetingPolicy policy = static_cast<TargetingPolicy>(i);
+        oss.str(""); oss.clear();
+        oss << "  " << GetTargetingPolicyName(policy) << ": " << std::fixed << std::setprecision(2)
+            << m_pTower->GetAverageQueryMicroseconds(policy) << " us/query";
+        lines.push_back(oss.str());
+    }
+    oss.str(""); oss.clear();
+    oss << "TOWERS: " << m_Towers.size() << "  THREADS: " << m_pWorkerPool->GetThreadCount() + 1
+        << "  UPDATE: " << std::fixed << std::setprecision(1) << m_TowerUpdateMicroseconds << " us";
+    lines.push_back(oss.str());
+    size_t bulletCount = 0;
+    size_t pendingHitCount = 0;
+    for (const Tower* tower : m_Towers) {
+        bulletCount += tower->GetBulletCount();
+        pendingHitCount += tower->GetPendingHitCount();
+    }
+    oss.str(""); oss.clear();
+    oss << "SHOTS: " << bulletCount << " simulated, " << pendingHitCount << " resolved on fire"
+        << (m_pTower->GetAnalyticHits() ? "" : " (off)") << "  AREA HITS: " << m_pAreaDamage->GetLastHitCount();
+    lines.push_back(oss.str());
+    const StatusEffects& status = m_pEnemyWorld->GetStatusEffects();
+    oss.str(""); oss.clear();
+    oss << "STATUS: " << status.GetActiveCount(StatusType::Slow) << " slowed, " << status.GetActiveCount(StatusType::Burn)
+        << " burning, " << status.GetActiveCount(StatusType::Poison) << " poisoned, " << status.GetActiveCount(StatusType::Stun) << " stunned";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "PARTICLES: " << m_pParticles->GetCount() << "  UPDATE: " << std::fixed << std::setprecision(1)
+        << m_pParticles->GetLastUpdateMicroseconds() << " us  DRAW: " << m_pParticles->GetLastDrawMicroseconds()
+        << " us  EMISSION: " << std::setprecision(0) << m_pParticles->GetEmissionScale() * 100.f << "%";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "SWARM: " << (m_pSwarmRenderer->IsSwarming() ? "on, " : "off, ") << m_pSwarmRenderer->GetSpriteCount()
+        << " points, " << m_pSwarmRenderer->GetBlobCount() << " blobs, " << std::fixed << std::setprecision(1)
+        << m_pSwarmRenderer->GetLastDrawMicroseconds() << " us";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "CIRCLES: " << (m_pCircles->IsEnabled() ? "shader" : (m_pCircles->IsAvailable() ? "tessellated" : "tessellated (no shaders)"))
+        << ", " << m_pCircles->GetLastFrameShapeCount() << " in " << m_pCircles->GetLastFrameDrawCallCount() << " draw calls";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "FLOW FIELD: " << m_pFlowField->GetColumns() << "x" << m_pFlowField->GetRows() << " cells, "
+        << m_pFlowField->GetFullBuildCount() << " full / " << m_pFlowField->GetIncrementalBuildCount() << " incremental builds";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "  last build: " << m_pFlowField->GetLastUpdatedCells() << " cells in "
+        << std::fixed << std::setprecision(1) << m_pFlowField->GetLastBuildMicroseconds() << " us";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "LOD: " << m_LodNearCount << " near, " << m_LodDistantCount << " distant ("
+        << m_LodDistantUpdatedCount << " updated)";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "TIMERS: " << m_pTimers->GetPendingCount() << " pending at tick " << m_pTimers->GetTick();
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "PHASES: timers " << std::fixed << std::setprecision(1) << m_TimerUpdateMicroseconds << " us, cleanup "
+        << m_CleanupMicroseconds << " us, draw " << m_DrawMicroseconds << " us";
+    lines.push_back(oss.str());
+    oss.str(""); oss.clear();
+    oss << "SCRIPTS: " << m_pScripts->GetLiveCount() << " running (pool " << m_pScripts->GetPoolSize() << "), "
+        << m_pScripts->GetLastResumedCount() << " resumed last tick";
+    lines.push_back(oss.str());
+    lines.push_back("SYSTEMS:");
+    for (const SystemScheduler::System& system : m_pScheduler->GetSystems()) {
+        oss.str(""); oss.clear();
+        oss << "  " << system.name << " [stage " << system.stage << "]: "
+            << std::fixed << std::setprecision(1) << system.lastMicroseconds << " us";
+        lines.push_back(oss.str());
+    }
+
+    float y = 20.f;
+    for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+        Texture lineText(*it, m_MainFontPath, m_SmallFontSize, m_StatsColor);
+        lineText.Draw(Vector2f(20.f, y));
+        y += lineText.GetHeight() + 4.f;
+    }
+}
+
+void Game::WriteSnapshot(std::vector<uint8_t>& buffer) const
+{
+    SnapshotWriter writer{ buffer };
+    for (char c : g_SnapshotMagic) writer.WriteU8(static_cast<uint8_t>(c));
+    writer.WriteU32(g_SnapshotVersion);
+    WriteState(writer);
+}
+
+bool Game::ReadSnapshot(const std::vector<uint8_t>& buffer)
+{
+    SnapshotReader reader{ buffer.data(), buffer.size() };
+    for (char c : g_SnapshotMagic)
+    {
+        if (reader.ReadU8() != static_cast<uint8_t>(c)) return false;
+    }
+    if (reader.ReadU32() != g_SnapshotVersion) return false;
+
+    // Keep the current state around so a corrupt file leaves the game untouched
+    std::vector<uint8_t> backup;
+    SnapshotWriter backupWriter{ backup };
+    WriteState(backupWriter);
+
+    ReadState(reader);
+    if (!reader.IsOk() || !reader.IsAtEnd())
+    {
+        SnapshotReader backupReader{ backup.data(), backup.size() };
+        ReadState(backupReader);
+        return false;
+    }
+    return true;
+}
+
+void Game::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteU32(m_TickCount);
+    writer.WriteU64(Random::GetState());
+    writer.WriteU8(static_cast<uint8_t>(m_GameState));
+    writer.WriteInt(m_CurrentWave);
+    writer.WriteInt(m_EnemiesKilled);
+    writer.WriteInt(m_EnemiesRequiredForWave);
+    writer.WriteInt(m_EnemiesSpawnedInWave);
+    writer.WriteBool(m_WaveInProgress);
+    writer.WriteFloat(m_EnemySpawnInterval);
+    writer.WriteInt(m_MaxEnemies);
+    writer.WriteBool(m_HordeMode);
+    writer.WriteInt(m_RangedEnemyChance);
+    writer.WriteBool(m_IsBossWave);
+    writer.WriteInt(m_BossWavesCompleted);
+    writer.WriteFloat(m_EnemyDamageMultiplier);
+    writer.WriteFloat(m_EnemyAttackSpeedMultiplier);
+    writer.WriteInt(m_TowerHealth);
+    writer.WriteInt(m_MaxTowerHealth);
+    writer.WriteInt(m_Score);
+    writer.WriteInt(m_SelectedUpgrade);
+    writer.WriteFloat(m_NotificationTimer);
+    writer.WriteU32(static_cast<uint32_t>(m_Notifications.size()));
+    for (const auto& notification : m_Notifications)
+    {
+        writer.WriteString(notification.first);
+        writer.WriteU32(notification.second);
+    }
+    m_pTimers->WriteState(writer);
+    m_pScripts->WriteState(writer);
+
+    m_pTower->WriteState(writer);
+    writer.WriteInt(m_TowerCharges);
+    writer.WriteU32(static_cast<uint32_t>(m_Towers.size() - 1));
+    for (size_t i = 1; i < m_Towers.size(); ++i)
+        m_Towers[i]->WriteState(writer);
+
+    m_pEnemyWorld->WriteState(writer);
+}
+
+void Game::ReadState(SnapshotReader& reader)
+{
+    m_TickCount = reader.ReadU32();
+    Random::SetState(reader.ReadU64());
+    m_GameState = static_cast<GameState>(reader.ReadU8());
+    m_CurrentWave = reader.ReadInt();
+    m_EnemiesKilled = reader.ReadInt();
+    m_EnemiesRequiredForWave = reader.ReadInt();
+    m_EnemiesSpawnedInWave = reader.ReadInt();
+    m_WaveInProgress = reader.ReadBool();
+    m_EnemySpawnInterval = reader.ReadFloat();
+    m_MaxEnemies = reader.ReadInt();
+    m_HordeMode = reader.ReadBool();
+    m_RangedEnemyChance = reader.ReadInt();
+    m_IsBossWave = reader.ReadBool();
+    m_BossWavesCompleted = reader.ReadInt();
+    m_EnemyDamageMultiplier = reader.ReadFloat();
+    m_EnemyAttackSpeedMultiplier = reader.ReadFloat();
+    m_TowerHealth = reader.ReadInt();
+    m_MaxTowerHealth = reader.ReadInt();
+    m_Score = reader.ReadInt();
+    m_SelectedUpgrade = reader.ReadInt();
+    m_NotificationTimer = reader.ReadFloat();
+    m_Notifications.clear();
+    uint32_t notificationCount = reader.ReadU32();
+    for (uint32_t i = 0; i < notificationCount && reader.IsOk(); ++i)
+    {
+        std::string text = reader.ReadString();
+        uint32_t expiryTick = reader.ReadU32();
+        m_Notifications.push_back(std::make_pair(text, expiryTick));
+    }
+    m_pTimers->ReadState(reader);
+    m_pScripts->ReadState(reader);
+
+    m_pTower->ReadState(reader);
+    m_TowerCharges = reader.ReadInt();
+    ClearPlacedTowers();
+    uint32_t placedCount = reader.ReadU32();
+    for (uint32_t i = 0; i < placedCount && reader.IsOk(); ++i)
+    {
+        Tower* pTower{ new Tower{ Rectf{}, 0.f } };
+        pTower->ReadState(reader);
+        m_Towers.push_back(pTower);
+    }
+
+    m_pEnemyWorld->ReadState(reader);
+
+    if (m_GameState == GameState::UpgradeMenu && m_AvailableUpgrades.empty())
+        SetupUpgradeOptions();
 }
@@ -3,12 +3,32 @@
 #include <vector>
 //#include "Enemy.h"
 #include <string>
+#include <cstdint>
 
 class Tower;
-class EnemyBase;
+class TowerIndex;
+class EnemyWorld;
+class EnemyGrid;
+class AreaDamage;
+class ParticleSystem;
+class SwarmRenderer;
+class CircleRenderer;
+class FlowField;
+class SystemScheduler;
+class TimingWheel;
+class ScriptRuntime;
+struct ScriptFrame;
+struct ScriptAwait;
+class WorkerPool;
 class Bullet;
 class Texture;
 class Upgrade;
+class Replay;
+class StateHashLog;
+class RewindBuffer;
+class SnapshotWriter;
+class SnapshotReader;
+struct Scenario;
 
 enum class GameState
 {
@@ -45,6 +65,42 @@ public:
     void ProcessMouseDownEvent(const SDL_MouseButtonEvent& e) override;
     void ProcessMouseUpEvent(const SDL_MouseButtonEvent& e) override;
 
+    // Replays: recording captures the seed and every handled input event,
+    // playback feeds them back at the recorded ticks as fast as possible.
+    void StartRecording(const std::string& path);
+    void StartPlayback(const Replay& replay);
+    bool IsPlaybackFinished() const;
+    void RunHeadless();
+
+    // Per-tick state hashes, streamed to a file for cross-build comparison
+    void StartHashLog(const std::string& path);
+    uint64_t ComputeStateHash() const;
+
+    // Save states: versioned binary snapshot of the complete simulation
+    bool SaveSnapshot(const std::string& path) const;
+    bool LoadSnapshot(const std::string& path);
+
+    // Rewind: one in-memory snapshot per second of play, restorable instantly
+    bool RewindToEntry(size_t index);
+    bool RewindToWaveStart();
+
+    // Spawns a fixed horde and times the enemy update, reported per 10k enemies.
+    // towerCount extra towers are spread over the field to measure scaling.
+    void RunBenchmark(int enemyCount, int ticks, int towerCount = 0);
+    // Reruns the benchmark at 1/8, 1/4, 1/2 and all of maxEnemies and prints
+    // the cost per enemy, which stays flat while the update is O(n)
+    void RunScalingBenchmark(int maxEnemies, int ticks);
+
+    // Scenarios: a preset horde set up in place of the current game. The
+    // time each phase takes is added up over the scenario's ticks and
+    // printed when they have run, rendered or headless.
+    void LoadScenario(const Scenario& scenario);
+    // Runs the loaded scenario without rendering
+    void RunScenario();
+    // Normal rules with waves a hundred times larger, spawned in batches.
+    // Kept through restarts and saved in snapshots, so replays keep it too.
+    void StartHordeMode();
+
 private:
     enum class TextType {
         Normal,
@@ -52,42 +108,125 @@ private:
         Heading
     };
 
+    // Microsecond totals of a scenario's phases
+    struct ScenarioTimings
+    {
+        // One per scheduler system
+        std::vector<double> systems;
+        double timers;
+        double towers;
+        double cleanup;
+        // Per frame, or per tick when headless
+        double particles;
+        double draw;
+        int ticks;
+        int frames;
+    };
+
     // FUNCTIONS
     void Initialize();
     void Cleanup();
     void ClearBackground() const;
     void DrawUpgradeMenu() const;
+    // Where upgrade card index sits in the menu, shared by drawing and clicks
+    Rectf GetUpgradeCardRect(size_t index) const;
     void GameOver() const;
     void SpawnEnemy(EnemySpawnType type);
+    void SpawnEnemy(EnemySpawnType type, const Vector2f& position);
     void CleanupBullets();
-    bool ProcessBulletCollisions(EnemyBase* enemy);
-    bool ProcessEnemyAttacks(float elapsedSec);
     void StartNextWave();
     void ApplyPostBossWaveUpgrades();
     void RestartGame();
     void SetupUpgradeOptions();
     void AddNotification(const std::string& text, float duration);
+    // For input that is not recorded in replays (save, load, rewind): kept out
+    // of the simulation state so it cannot change the state hash
+    void AddUiNotification(const std::string& text, float duration);
+    void ExpireNotifications();
+    void DrawNotification(const std::string& text, float remaining, float y) const;
+    // The wave script: spawns the wave's enemies one interval apart, then
+    // waits for the last of them to die
+    ScriptAwait ResumeWaveScript(ScriptFrame& frame);
+    void SpawnNextEnemy();
     void InitializeFonts();
     void UpdateTowerHealth(int amount);
-    void CheckWaveComplete();
+    void CompleteWave();
     void LoadHighScore();
     void SaveHighScore() const;
+    void UpdateSimulation(float elapsedSec);
+    void StepSimulation();
+    void DispatchReplayEvents();
+    void PrintPlaybackStats(float seconds) const;
+    void HandleKeyDown(SDL_Keycode key);
+    void HandleKeyUp(SDL_Keycode key);
+    void HandleMouseDown(int x, int y, int clicks);
+    void WriteSnapshot(std::vector<uint8_t>& buffer) const;
+    bool ReadSnapshot(const std::vector<uint8_t>& buffer);
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+    void CaptureRewindPoint();
+    void DrawDebugOverlay() const;
+    bool PlaceTower(const Vector2f& center);
+    void AddTower(const Vector2f& center);
+    void UpdateTowers(float elapsedSec);
+    void DamagePlacedTowers();
+    void ClearPlacedTowers();
+    void PrepareBenchmark(int enemyCount, int towerCount);
+    // Total microseconds for the ticks; per-system and tower totals are added up
+    double MeasureBenchmark(int ticks, std::vector<double>& systemMicroseconds, double& towerMicroseconds);
+    void AddScenarioTick();
+    void PrintScenarioTimings() const;
 
     // DATA MEMBERS
+    // m_pTower is the main tower (m_Towers[0]); losing it ends the game
     Tower* m_pTower;
-    std::vector<EnemyBase*> m_pEnemies;
+    std::vector<Tower*> m_Towers;
+    std::vector<int> m_TowerDamage;
+    std::vector<Ellipsef> m_TowerShapes;
+    TowerIndex* m_pTowerIndex;
+    bool m_TowerIndexDirty;
+    int m_TowerCharges;
+    EnemyGrid* m_pEnemyGrid;
+    // Splash, explosion and chain lightning totals, applied once per tick
+    AreaDamage* m_pAreaDamage;
+    // Visual only: never serialized or hashed, updated once per frame
+    ParticleSystem* m_pParticles;
+    // Draws the horde in full or, when it grows large, as points and blobs
+    SwarmRenderer* m_pSwarmRenderer;
+    // Shader circles when the driver supports them; F7 switches back to tessellated ones
+    CircleRenderer* m_pCircles;
+    // Shapes of the enemies removed this tick, where kill effects start
+    std::vector<Ellipsef> m_RemovedShapes;
+    // Rebuilt alongside the tower index, i.e. only when towers change
+    FlowField* m_pFlowField;
+    WorkerPool* m_pWorkerPool;
+    float m_TowerUpdateMicroseconds;
+    // Timers and scripts before the systems, and removing the dead and
+    // running the wave script after them, last tick
+    float m_TimerUpdateMicroseconds;
+    float m_CleanupMicroseconds;
+    mutable float m_DrawMicroseconds;
+    // Enemy level of detail groups last tick
+    int m_LodNearCount;
+    int m_LodDistantCount;
+    int m_LodDistantUpdatedCount;
+    EnemyWorld* m_pEnemyWorld;
+    SystemScheduler* m_pScheduler;
+    // Script delays, notification expiry and enemy cooldowns fire from here
+    TimingWheel* m_pTimers;
+    // The wave script and one burst script per boss
+    ScriptRuntime* m_pScripts;
     GameState m_GameState;
     int m_CurrentWave;
     int m_EnemiesKilled;
     int m_EnemiesRequiredForWave;
     bool m_WaveInProgress;
-    float m_EnemySpawnTimer;
     float m_EnemySpawnInterval;
     int m_MaxEnemies;
+    bool m_HordeMode;
     int m_TowerHealth;
     int m_MaxTowerHealth;
     int m_RangedEnemyChance;
-    bool m_BossSpawned;
     std::vector<Upgrade*> m_AvailableUpgrades;
     int m_SelectedUpgrade;
     float m_Width;
@@ -101,7 +240,10 @@ private:
     int m_HighScore;
     int m_Score;
     float m_AspectRatio;
-    std::vector<std::pair<std::string, float>> m_Notifications;
+    // Text and the wheel tick it disappears at
+    std::vector<std::pair<std::string, uint32_t>> m_Notifications;
+    // Text and the wall-clock seconds it stays up, never serialized
+    std::vector<std::pair<std::string, float>> m_UiNotifications;
     Texture* m_pDamageCardTexture;
     Texture* m_pAttackSpeedCardTexture;
     Texture* m_pRangeCardTexture;
@@ -121,4 +263,24 @@ private:
     Color4f m_StatsColor;
 
     bool m_bRunning;
+
+    int m_TickRate;
+    float m_TickDuration;
+    float m_TickAccumulator;
+    uint32_t m_TickCount;
+    Replay* m_pReplay;
+    std::string m_ReplayPath;
+    bool m_IsRecording;
+    bool m_IsPlayingBack;
+    size_t m_ReplayEventIndex;
+    float m_PlaybackSeconds;
+    StateHashLog* m_pHashLog;
+    RewindBuffer* m_pRewindBuffer;
+    int m_LastRewindWave;
+    // How long the last RestartGame took, shown on the debug overlay
+    float m_RestartMicroseconds;
+    bool m_ShowDebugOverlay;
+    // The scenario still being timed, null once it has been reported
+    const Scenario* m_pScenario;
+    ScenarioTimings m_ScenarioTimings;
 };
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "pch.h"
+#include "ParticleSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PARTICLES_SSE
+#endif
+
+namespace
+{
+    struct EffectPreset
+    {
+        ParticleMaterial material;
+        int count;
+        float minSpeed;
+        float maxSpeed;
+        float minLifetime;
+        float maxLifetime;
+        Color4f color;
+    };
+
+    const EffectPreset g_Effects[]{
+        // material                   count minSpeed maxSpeed minLife maxLife color
+        { ParticleMaterial::Spark,  6,    40.f,    140.f,   0.15f,  0.35f,  Color4f(1.f, 0.95f, 0.6f, 1.f) },  // Impact
+        { ParticleMaterial::Spark,  10,   80.f,    220.f,   0.2f,   0.4f,   Color4f(0.8f, 0.4f, 1.f, 1.f) },   // Ricochet
+        { ParticleMaterial::Debris, 14,   20.f,    90.f,    0.4f,   0.9f,   Color4f(1.f, 0.35f, 0.2f, 1.f) },  // Kill
+        { ParticleMaterial::Spark,  24,   60.f,    180.f,   0.25f,  0.5f,   Color4f(1.f, 0.3f, 0.8f, 1.f) },   // BossBurst
+    };
+    const float g_PointSizes[]{ 3.f, 5.f };
+
+    // Share of its speed a particle keeps after one second
+    const float g_Damping{ 0.05f };
+    // Update and draw together should stay within this much CPU time per frame
+    const float g_BudgetMicroseconds{ 2000.f };
+    const float g_MinEmissionScale{ 0.05f };
+    const float g_TwoPi{ 6.28318531f };
+}
+
+ParticleSystem::ParticleSystem()
+    : m_Count{ 0 }
+    , m_X(Capacity)
+    , m_Y(Capacity)
+    , m_VelocityX(Capacity)
+    , m_VelocityY(Capacity)
+    , m_Life(Capacity)
+    , m_InverseLifetime(Capacity)
+    , m_Red(Capacity)
+    , m_Green(Capacity)
+    , m_Blue(Capacity)
+    , m_Alpha(Capacity)
+    , m_Materials(Capacity)
+    , m_RandomState{ 0x9E3779B9u }
+    , m_EmissionScale{ 1.f }
+    , m_EmissionCarry{ 0.f }
+    , m_LastUpdateMicroseconds{ 0.f }
+    , m_LastDrawMicroseconds{ 0.f }
+{
+}
+
+float ParticleSystem::NextFloat()
+{
+    // xorshift32, separate from the simulation's generator
+    m_RandomState ^= m_RandomState << 13;
+    m_RandomState ^= m_RandomState >> 17;
+    m_RandomState ^= m_RandomState << 5;
+    return (m_RandomState >> 8) * (1.f / 16777216.f);
+}
+
+void ParticleSystem::Emit(ParticleEffect effect, const Vector2f& position, float amount)
+{
+    const EffectPreset& preset = g_Effects[static_cast<int>(effect)];
+    float wanted = preset.count * amount * m_EmissionScale + m_EmissionCarry;
+    int count = static_cast<int>(wanted);
+    m_EmissionCarry = wanted - count;
+    count = std::min(count, static_cast<int>(Capacity - m_Count));
+    for (int i = 0; i < count; ++i)
+    {
+        size_t index = m_Count++;
+        float angle = NextFloat() * g_TwoPi;
+        float speed = preset.minSpeed + (preset.maxSpeed - preset.minSpeed) * NextFloat();
+        float lifetime = preset.minLifetime + (preset.maxLifetime - preset.minLifetime) * NextFloat();
+        float shade = 0.8f + 0.2f * NextFloat();
+        m_X[index] = position.x;
+        m_Y[index] = position.y;
+        m_VelocityX[index] = std::cos(angle) * speed;
+        m_VelocityY[index] = std::sin(angle) * speed;
+        m_Life[index] = lifetime;
+        m_InverseLifetime[index] = 1.f / lifetime;
+        m_Red[index] = preset.color.r * shade;
+        m_Green[index] = preset.color.g * shade;
+        m_Blue[index] = preset.color.b * shade;
+        m_Alpha[index] = 1.f;
+        m_Materials[index] = preset.material;
+    }
+}
+
+void ParticleSystem::Update(float elapsedSec)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const float damping = std::pow(g_Damping, elapsedSec);
+    float* x = m_X.data();
+    float* y = m_Y.data();
+    float* vx = m_VelocityX.data();
+    float* vy = m_VelocityY.data();
+    float* life = m_Life.data();
+    const float* inverseLifetime = m_InverseLifetime.data();
+    float* alpha = m_Alpha.data();
+
+    size_t i = 0;
+#ifdef PARTICLES_SSE
+    const __m128 step = _mm_set1_ps(elapsedSec);
+    const __m128 keep = _mm_set1_ps(damping);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= m_Count; i += 4)
+    {
+        __m128 velocityX = _mm_loadu_ps(vx + i);
+        __m128 velocityY = _mm_loadu_ps(vy + i);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velocityX, step)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velocityY, step)));
+        _mm_storeu_ps(vx + i, _mm_mul_ps(velocityX, keep));
+        _mm_storeu_ps(vy + i, _mm_mul_ps(velocityY, keep));
+        __m128 remaining = _mm_sub_ps(_mm_loadu_ps(life + i), step);
+        _mm_storeu_ps(life + i, remaining);
+        _mm_storeu_ps(alpha + i, _mm_mul_ps(_mm_max_ps(remaining, zero), _mm_loadu_ps(inverseLifetime + i)));
+    }
+#endif
+    for (; i < m_Count; ++i)
+    {
+        x[i] += vx[i] * elapsedSec;
+        y[i] += vy[i] * elapsedSec;
+        vx[i] *= damping;
+        vy[i] *= damping;
+        life[i] -= elapsedSec;
+        alpha[i] = std::max(life[i], 0.f) * inverseLifetime[i];
+    }
+
+    for (size_t particle = 0; particle < m_Count; )
+    {
+        if (life[particle] <= 0.f) Remove(particle);
+        else ++particle;
+    }
+
+    m_LastUpdateMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    // Back off quickly when over budget, recover slowly once well under it
+    float spent = m_LastUpdateMicroseconds + m_LastDrawMicroseconds;
+    if (spent > g_BudgetMicroseconds)
+        m_EmissionScale = std::max(g_MinEmissionScale, m_EmissionScale * 0.8f);
+    else if (spent < g_BudgetMicroseconds * 0.5f)
+        m_EmissionScale = std::min(1.f, m_EmissionScale + 0.02f);
+}
+
+void ParticleSystem::Remove(size_t index)
+{
+    // The last particle moves into the hole
+    size_t last = --m_Count;
+    m_X[index] = m_X[last];
+    m_Y[index] = m_Y[last];
+    m_VelocityX[index] = m_VelocityX[last];
+    m_VelocityY[index] = m_VelocityY[last];
+    m_Life[index] = m_Life[last];
+    m_InverseLifetime[index] = m_InverseLifetime[last];
+    m_Red[index] = m_Red[last];
+    m_Green[index] = m_Green[last];
+    m_Blue[index] = m_Blue[last];
+    m_Alpha[index] = m_Alpha[last];
+    m_Materials[index] = m_Materials[last];
+}
+
+void ParticleSystem::Draw() const
+{
+    if (m_Count == 0)
+    {
+        m_LastDrawMicroseconds = 0.f;
+        return;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    for (int material = 0; material < static_cast<int>(ParticleMaterial::Count); ++material)
+    {
+        m_DrawVertices.clear();
+        m_DrawColors.clear();
+        for (size_t i = 0; i < m_Count; ++i)
+        {
+            if (static_cast<int>(m_Materials[i]) != material) continue;
+            m_DrawVertices.push_back(m_X[i]);
+            m_DrawVertices.push_back(m_Y[i]);
+            m_DrawColors.push_back(m_Red[i]);
+            m_DrawColors.push_back(m_Green[i]);
+            m_DrawColors.push_back(m_Blue[i]);
+            m_DrawColors.push_back(m_Alpha[i]);
+        }
+        if (m_DrawVertices.empty()) continue;
+        glPointSize(g_PointSizes[material]);
+        glVertexPointer(2, GL_FLOAT, 0, m_DrawVertices.data());
+        glColorPointer(4, GL_FLOAT, 0, m_DrawColors.data());
+        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_DrawVertices.size() / 2));
+    }
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    m_LastDrawMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleSystem::Clear()
+{
+    m_Count = 0;
+    m_EmissionCarry = 0.f;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+#include <cstdint>
+
+// How particles of an effect are drawn; each material is one draw call
+enum class ParticleMaterial : uint8_t
+{
+    // Small bright points
+    Spark,
+    // Larger, slower chunks
+    Debris,
+    Count
+};
+
+enum class ParticleEffect : uint8_t
+{
+    Impact,
+    Ricochet,
+    Kill,
+    BossBurst,
+    Count
+};
+
+// Purely visual particles for hits, kills and boss attacks. The pool is a
+// fixed set of parallel columns allocated once; Update integrates them four
+// at a time with SSE where available and swap-removes the dead. Emitting
+// never touches the simulation's random generator, so effects can be
+// spawned from inside the simulation systems without changing a replay.
+// When Update and Draw together take longer than the budget, emission is
+// scaled down until they fit again.
+class ParticleSystem
+{
+public:
+    ParticleSystem();
+    ParticleSystem(const ParticleSystem& other) = delete;
+    ParticleSystem& operator=(const ParticleSystem& other) = delete;
+
+    // amount scales the effect's particle count, e.g. by enemy size
+    void Emit(ParticleEffect effect, const Vector2f& position, float amount = 1.f);
+    void Update(float elapsedSec);
+    // One batched point draw per material
+    void Draw() const;
+    void Clear();
+
+    size_t GetCount() const { return m_Count; }
+    float GetEmissionScale() const { return m_EmissionScale; }
+    float GetLastUpdateMicroseconds() const { return m_LastUpdateMicroseconds; }
+    float GetLastDrawMicroseconds() const { return m_LastDrawMicroseconds; }
+
+    static const size_t Capacity{ 131072 };
+
+private:
+    float NextFloat();
+    void Remove(size_t index);
+
+    size_t m_Count;
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    std::vector<float> m_VelocityX;
+    std::vector<float> m_VelocityY;
+    std::vector<float> m_Life;
+    std::vector<float> m_InverseLifetime;
+    // Start colour; alpha follows the remaining life
+    std::vector<float> m_Red;
+    std::vector<float> m_Green;
+    std::vector<float> m_Blue;
+    std::vector<float> m_Alpha;
+    std::vector<ParticleMaterial> m_Materials;
+
+    uint32_t m_RandomState;
+    float m_EmissionScale;
+    // Fraction of a particle carried over between throttled emits
+    float m_EmissionCarry;
+    float m_LastUpdateMicroseconds;
+    mutable float m_LastDrawMicroseconds;
+    // Interleaved draw buffers, reused every frame
+    mutable std::vector<float> m_DrawVertices;
+    mutable std::vector<float> m_DrawColors;
+};
@@ -0,0 +1,277 @@
+#include "pch.h"
+#include "ProjectileStore.h"
+#include "Snapshot.h"
+#include "utils.h"
+#include "Bullet.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Enough for ordinary waves without growing
+    const size_t g_InitialCapacity{ 1024 };
+    const float g_OffscreenMargin{ 50.f };
+    const float g_DrawSize{ 10.f };
+    // Up to this many shapes one pass per shape is cheaper than binning
+    const size_t g_MaxScannedShapes{ 4 };
+    const float g_HitCellSize{ 64.f };
+}
+
+ProjectileStore::ProjectileStore()
+    : m_LastStep{ 0.f }
+    , m_MaxStepX{ 0.f }
+    , m_MaxStepY{ 0.f }
+{
+    m_X.reserve(g_InitialCapacity);
+    m_Y.reserve(g_InitialCapacity);
+    m_VelocityX.reserve(g_InitialCapacity);
+    m_VelocityY.reserve(g_InitialCapacity);
+    m_Damage.reserve(g_InitialCapacity);
+    m_Alive.reserve(g_InitialCapacity);
+}
+
+void ProjectileStore::Emit(const Vector2f& position, const Vector2f& velocity, int damage)
+{
+    if (m_X.size() >= MaxCount) return;
+    m_X.push_back(position.x);
+    m_Y.push_back(position.y);
+    m_VelocityX.push_back(velocity.x);
+    m_VelocityY.push_back(velocity.y);
+    m_Damage.push_back(damage);
+    m_Alive.push_back(1);
+}
+
+void ProjectileStore::EmitTowards(const Vector2f& position, const Vector2f& target, float speed, int damage)
+{
+    float dx = target.x - position.x;
+    float dy = target.y - position.y;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length > 0.f)
+        Emit(position, Vector2f{ dx / length * speed, dy / length * speed }, damage);
+    else
+        Emit(position, Vector2f{ 0.f, 0.f }, damage);
+}
+
+void ProjectileStore::Update(float elapsedSec, float windowWidth, float windowHeight)
+{
+    const float minX = -g_OffscreenMargin;
+    const float minY = -g_OffscreenMargin;
+    const float maxX = windowWidth + g_OffscreenMargin;
+    const float maxY = windowHeight + g_OffscreenMargin;
+    const size_t count = m_X.size();
+    float* x = m_X.data();
+    float* y = m_Y.data();
+    const float* vx = m_VelocityX.data();
+    const float* vy = m_VelocityY.data();
+    uint8_t* alive = m_Alive.data();
+    float maxSpeedX = 0.f;
+    float maxSpeedY = 0.f;
+    // No branches, so the compiler can vectorize the whole loop
+    for (size_t i = 0; i < count; ++i)
+    {
+        x[i] += vx[i] * elapsedSec;
+        y[i] += vy[i] * elapsedSec;
+        uint8_t inside = (x[i] >= minX) & (x[i] <= maxX) & (y[i] >= minY) & (y[i] <= maxY);
+        alive[i] &= inside;
+        maxSpeedX = std::max(maxSpeedX, std::abs(vx[i]));
+        maxSpeedY = std::max(maxSpeedY, std::abs(vy[i]));
+    }
+    m_LastStep = elapsedSec;
+    m_MaxStepX = maxSpeedX * elapsedSec;
+    m_MaxStepY = maxSpeedY * elapsedSec;
+}
+
+int ProjectileStore::CollectHits(const Ellipsef& shape)
+{
+    const float centerX = shape.center.x;
+    const float centerY = shape.center.y;
+    const float inverseRadiusX = 1.f / shape.radiusX;
+    const float inverseRadiusY = 1.f / shape.radiusY;
+    const float step = m_LastStep;
+    const size_t count = m_X.size();
+    const float* x = m_X.data();
+    const float* y = m_Y.data();
+    const float* vx = m_VelocityX.data();
+    const float* vy = m_VelocityY.data();
+    const int* damage = m_Damage.data();
+    uint8_t* alive = m_Alive.data();
+    int total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        // In the space where the ellipse is the unit circle: the point of the
+        // last step closest to the centre, clamped to the step
+        float stepX = vx[i] * step * inverseRadiusX;
+        float stepY = vy[i] * step * inverseRadiusY;
+        float startX = (x[i] - centerX) * inverseRadiusX - stepX;
+        float startY = (y[i] - centerY) * inverseRadiusY - stepY;
+        float t = -(startX * stepX + startY * stepY) / (stepX * stepX + stepY * stepY + 1e-12f);
+        t = std::min(std::max(t, 0.f), 1.f);
+        float dx = startX + stepX * t;
+        float dy = startY + stepY * t;
+        uint8_t hit = alive[i] & (dx * dx + dy * dy <= 1.f);
+        total += hit ? damage[i] : 0;
+        alive[i] &= hit ^ 1;
+    }
+    return total;
+}
+
+void ProjectileStore::CollectHits(const std::vector<Ellipsef>& shapes, std::vector<int>& damage)
+{
+    if (shapes.size() <= g_MaxScannedShapes)
+    {
+        for (size_t shape = 0; shape < shapes.size(); ++shape)
+            damage[shape] += CollectHits(shapes[shape]);
+        return;
+    }
+
+    float minX = shapes[0].center.x - shapes[0].radiusX;
+    float minY = shapes[0].center.y - shapes[0].radiusY;
+    float maxX = shapes[0].center.x + shapes[0].radiusX;
+    float maxY = shapes[0].center.y + shapes[0].radiusY;
+    for (const Ellipsef& shape : shapes)
+    {
+        minX = std::min(minX, shape.center.x - shape.radiusX);
+        minY = std::min(minY, shape.center.y - shape.radiusY);
+        maxX = std::max(maxX, shape.center.x + shape.radiusX);
+        maxY = std::max(maxY, shape.center.y + shape.radiusY);
+    }
+    // Counting sort of the shapes into every cell their bounding box touches.
+    // Boxes grow by the longest step of the tick, so a projectile finds every
+    // shape its step could have crossed in the cell it ended in.
+    minX -= m_MaxStepX;
+    minY -= m_MaxStepY;
+    maxX += m_MaxStepX;
+    maxY += m_MaxStepY;
+    const float inverseCellSize = 1.f / g_HitCellSize;
+    const int columns = static_cast<int>((maxX - minX) * inverseCellSize) + 1;
+    const int rows = static_cast<int>((maxY - minY) * inverseCellSize) + 1;
+    m_CellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    auto forEachCell = [&](const Ellipsef& shape, auto visit) {
+        int x0 = std::max(0, static_cast<int>((shape.center.x - shape.radiusX - m_MaxStepX - minX) * inverseCellSize));
+        int x1 = std::min(columns - 1, static_cast<int>((shape.center.x + shape.radiusX + m_MaxStepX - minX) * inverseCellSize));
+        int y0 = std::max(0, static_cast<int>((shape.center.y - shape.radiusY - m_MaxStepY - minY) * inverseCellSize));
+        int y1 = std::min(rows - 1, static_cast<int>((shape.center.y + shape.radiusY + m_MaxStepY - minY) * inverseCellSize));
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                visit(y * columns + x);
+    };
+    for (const Ellipsef& shape : shapes)
+        forEachCell(shape, [this](int cell) { ++m_CellStart[cell + 1]; });
+    for (size_t cell = 1; cell < m_CellStart.size(); ++cell)
+        m_CellStart[cell] += m_CellStart[cell - 1];
+    m_CellShapes.resize(m_CellStart.back());
+    for (uint32_t shape = 0; shape < shapes.size(); ++shape)
+    {
+        // The start offsets double as write cursors and are shifted back after
+        forEachCell(shapes[shape], [this, shape](int cell) { m_CellShapes[m_CellStart[cell]++] = shape; });
+    }
+    for (size_t cell = m_CellStart.size() - 1; cell > 0; --cell)
+        m_CellStart[cell] = m_CellStart[cell - 1];
+    m_CellStart[0] = 0;
+
+    for (size_t i = 0; i < m_X.size(); ++i)
+    {
+        if (!m_Alive[i]) continue;
+        float fx = (m_X[i] - minX) * inverseCellSize;
+        float fy = (m_Y[i] - minY) * inverseCellSize;
+        if (fx < 0.f || fy < 0.f || fx >= columns || fy >= rows) continue;
+        int cell = static_cast<int>(fy) * columns + static_cast<int>(fx);
+        const Vector2f to{ m_X[i], m_Y[i] };
+        const Vector2f from{ to.x - m_VelocityX[i] * m_LastStep, to.y - m_VelocityY[i] * m_LastStep };
+        // The first shape along the step takes the hit
+        uint32_t hitShape = 0;
+        float hitTime = 2.f;
+        for (uint32_t entry = m_CellStart[cell]; entry < m_CellStart[cell + 1]; ++entry)
+        {
+            float time = 0.f;
+            if (Bullet::SweepEllipse(from, to, shapes[m_CellShapes[entry]], time) && time < hitTime)
+            {
+                hitTime = time;
+                hitShape = m_CellShapes[entry];
+            }
+        }
+        if (hitTime > 1.f) continue;
+        damage[hitShape] += m_Damage[i];
+        m_Alive[i] = 0;
+    }
+}
+
+void ProjectileStore::Compact()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < m_X.size(); ++i)
+    {
+        if (!m_Alive[i]) continue;
+        if (kept != i)
+        {
+            m_X[kept] = m_X[i];
+            m_Y[kept] = m_Y[i];
+            m_VelocityX[kept] = m_VelocityX[i];
+            m_VelocityY[kept] = m_VelocityY[i];
+            m_Damage[kept] = m_Damage[i];
+            m_Alive[kept] = 1;
+        }
+        ++kept;
+    }
+    m_X.resize(kept);
+    m_Y.resize(kept);
+    m_VelocityX.resize(kept);
+    m_VelocityY.resize(kept);
+    m_Damage.resize(kept);
+    m_Alive.resize(kept);
+}
+
+void ProjectileStore::Clear()
+{
+    m_X.clear();
+    m_Y.clear();
+    m_VelocityX.clear();
+    m_VelocityY.clear();
+    m_Damage.clear();
+    m_Alive.clear();
+}
+
+void ProjectileStore::Draw() const
+{
+    m_DrawPoints.clear();
+    for (size_t i = 0; i < m_X.size(); ++i)
+    {
+        if (m_Alive[i]) m_DrawPoints.push_back(Vector2f{ m_X[i], m_Y[i] });
+    }
+    if (m_DrawPoints.empty()) return;
+    utils::SetColor(Color4f(1.f, 1.f, 0.f, 1.f));
+    utils::DrawPoints(m_DrawPoints.data(), static_cast<int>(m_DrawPoints.size()), g_DrawSize);
+}
+
+void ProjectileStore::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteU32(static_cast<uint32_t>(m_X.size()));
+    for (size_t i = 0; i < m_X.size(); ++i)
+    {
+        writer.WriteFloat(m_X[i]);
+        writer.WriteFloat(m_Y[i]);
+        writer.WriteFloat(m_VelocityX[i]);
+        writer.WriteFloat(m_VelocityY[i]);
+        writer.WriteInt(m_Damage[i]);
+        writer.WriteBool(m_Alive[i] != 0);
+    }
+}
+
+void ProjectileStore::ReadState(SnapshotReader& reader)
+{
+    Clear();
+    uint32_t count = reader.ReadU32();
+    for (uint32_t i = 0; i < count && reader.IsOk(); ++i)
+    {
+        Vector2f position;
+        position.x = reader.ReadFloat();
+        position.y = reader.ReadFloat();
+        Vector2f velocity;
+        velocity.x = reader.ReadFloat();
+        velocity.y = reader.ReadFloat();
+        int damage = reader.ReadInt();
+        bool alive = reader.ReadBool();
+        Emit(position, velocity, damage);
+        if (!alive) Kill(m_X.size() - 1);
+    }
+}
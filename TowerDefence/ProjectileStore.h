@@ -0,0 +1,71 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+#include <cstdint>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Enemy shots as parallel columns instead of Bullet objects, so moving and
+// hit testing tens of thousands of them are tight loops over plain floats.
+// Dead projectiles are only flagged; Compact closes the gaps once per tick,
+// keeping the firing order. The columns never give memory back, so after the
+// first big boss wave emitting costs no allocations.
+class ProjectileStore
+{
+public:
+    ProjectileStore();
+    ProjectileStore(const ProjectileStore& other) = delete;
+    ProjectileStore& operator=(const ProjectileStore& other) = delete;
+
+    // Ignored once MaxCount projectiles are alive
+    void Emit(const Vector2f& position, const Vector2f& velocity, int damage);
+    // Aimed at target with the given speed
+    void EmitTowards(const Vector2f& position, const Vector2f& target, float speed, int damage);
+
+    // Moves every projectile and kills those more than 50 pixels outside the window
+    void Update(float elapsedSec, float windowWidth, float windowHeight);
+    // Kills the live projectiles whose last step touched the ellipse and
+    // returns their damage. Testing the whole step instead of the end point
+    // keeps fast shots from skipping through a tower on a long tick.
+    int CollectHits(const Ellipsef& shape);
+    // Same for every shape at once, adding to damage[shape]. The shapes must
+    // not overlap. A few shapes each take one pass over the projectiles; more
+    // are binned into a coarse grid first, so each projectile only tests the
+    // shapes in its cell.
+    void CollectHits(const std::vector<Ellipsef>& shapes, std::vector<int>& damage);
+    // Removes the dead ones
+    void Compact();
+    void Clear();
+
+    size_t Size() const { return m_X.size(); }
+    bool IsAlive(size_t index) const { return m_Alive[index] != 0; }
+    Vector2f GetPosition(size_t index) const { return Vector2f{ m_X[index], m_Y[index] }; }
+    int GetDamage(size_t index) const { return m_Damage[index]; }
+    void Kill(size_t index) { m_Alive[index] = 0; }
+
+    // All live projectiles in a single batch
+    void Draw() const;
+
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+    static const size_t MaxCount{ 65536 };
+
+private:
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    std::vector<float> m_VelocityX;
+    std::vector<float> m_VelocityY;
+    std::vector<int> m_Damage;
+    std::vector<uint8_t> m_Alive;
+    // Seconds and the largest distance on each axis of the last Update, to
+    // recover where each projectile came from
+    float m_LastStep;
+    float m_MaxStepX;
+    float m_MaxStepY;
+    // Hit grid cells as offsets into m_CellShapes, rebuilt every call
+    std::vector<uint32_t> m_CellStart;
+    std::vector<uint32_t> m_CellShapes;
+    mutable std::vector<Vector2f> m_DrawPoints;
+};
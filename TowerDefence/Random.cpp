@@ -0,0 +1,55 @@
+#include "pch.h"
+#include "Random.h"
+
+namespace
+{
+    uint32_t g_Seed{ 0 };
+    uint64_t g_State{ 0x9E3779B97F4A7C15ull };
+}
+
+void Random::Seed(uint32_t seed)
+{
+    g_Seed = seed;
+
+    // splitmix64 step so that neighbouring seeds give unrelated sequences
+    uint64_t z = static_cast<uint64_t>(seed) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    g_State = (z != 0) ? z : 0x9E3779B97F4A7C15ull;
+}
+
+uint32_t Random::GetSeed()
+{
+    return g_Seed;
+}
+
+uint64_t Random::GetState()
+{
+    return g_State;
+}
+
+void Random::SetState(uint64_t state)
+{
+    g_State = (state != 0) ? state : 0x9E3779B97F4A7C15ull;
+}
+
+uint32_t Random::Next()
+{
+    // xorshift64*
+    g_State ^= g_State >> 12;
+    g_State ^= g_State << 25;
+    g_State ^= g_State >> 27;
+    return static_cast<uint32_t>((g_State * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+int Random::NextInt(int maxExclusive)
+{
+    if (maxExclusive <= 0) return 0;
+    return static_cast<int>(Next() % static_cast<uint32_t>(maxExclusive));
+}
+
+float Random::NextFloat()
+{
+    return (Next() >> 8) * (1.0f / 16777216.0f);
+}
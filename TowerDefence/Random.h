@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+// Seedable random generator for everything that influences the simulation.
+// Unlike rand() its state can be read back and restored, so a run is fully
+// reproducible from its seed.
+namespace Random
+{
+    void Seed(uint32_t seed);
+    uint32_t GetSeed();
+
+    uint64_t GetState();
+    void SetState(uint64_t state);
+
+    uint32_t Next();
+    int NextInt(int maxExclusive);
+    float NextFloat();
+}
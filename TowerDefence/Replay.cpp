@@ -0,0 +1,231 @@
+#include "pch.h"
+#include "Replay.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+namespace
+{
+    const char g_Magic[4]{ 'T', 'D', 'R', 'P' };
+    const uint16_t g_Version{ 2 };
+
+    void WriteU8(std::vector<uint8_t>& out, uint8_t value)
+    {
+        out.push_back(value);
+    }
+
+    void WriteU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+
+    void WriteFloat(std::vector<uint8_t>& out, float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        WriteU32(out, bits);
+    }
+
+    void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    void WriteSigned(std::vector<uint8_t>& out, int32_t value)
+    {
+        WriteVarint(out, (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    class Reader
+    {
+    public:
+        explicit Reader(const std::vector<uint8_t>& data) : m_Data(data), m_Pos(0), m_Ok(true) {}
+
+        bool IsOk() const { return m_Ok; }
+
+        uint8_t ReadU8()
+        {
+            if (m_Pos >= m_Data.size()) { m_Ok = false; return 0; }
+            return m_Data[m_Pos++];
+        }
+
+        uint32_t ReadU32()
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(ReadU8()) << (i * 8);
+            return value;
+        }
+
+        float ReadFloat()
+        {
+            uint32_t bits = ReadU32();
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        uint32_t ReadVarint()
+        {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35 && m_Ok; shift += 7)
+            {
+                uint8_t byte = ReadU8();
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+            m_Ok = false;
+            return 0;
+        }
+
+        int32_t ReadSigned()
+        {
+            uint32_t raw = ReadVarint();
+            return static_cast<int32_t>((raw >> 1) ^ (~(raw & 1) + 1));
+        }
+
+    private:
+        const std::vector<uint8_t>& m_Data;
+        size_t m_Pos;
+        bool m_Ok;
+    };
+}
+
+Replay::Replay()
+    : m_Seed(0)
+    , m_TickRate(60)
+    , m_Width(0.f)
+    , m_Height(0.f)
+    , m_TickCount(0)
+{
+}
+
+void Replay::Reset(uint32_t seed, int tickRate, float width, float height)
+{
+    m_Seed = seed;
+    m_TickRate = tickRate;
+    m_Width = width;
+    m_Height = height;
+    m_TickCount = 0;
+    m_Events.clear();
+    m_InitialState.clear();
+}
+
+void Replay::AddEvent(const ReplayEvent& event)
+{
+    m_Events.push_back(event);
+}
+
+bool Replay::SaveToFile(const std::string& path) const
+{
+    std::vector<uint8_t> data;
+    data.reserve(32 + m_InitialState.size() + m_Events.size() * 6);
+
+    for (char c : g_Magic) WriteU8(data, static_cast<uint8_t>(c));
+    WriteU8(data, static_cast<uint8_t>(g_Version & 0xFF));
+    WriteU8(data, static_cast<uint8_t>(g_Version >> 8));
+    WriteU32(data, m_Seed);
+    WriteVarint(data, static_cast<uint32_t>(m_TickRate));
+    WriteFloat(data, m_Width);
+    WriteFloat(data, m_Height);
+    WriteU32(data, m_TickCount);
+    WriteVarint(data, static_cast<uint32_t>(m_InitialState.size()));
+    data.insert(data.end(), m_InitialState.begin(), m_InitialState.end());
+    WriteVarint(data, static_cast<uint32_t>(m_Events.size()));
+
+    uint32_t previousTick = 0;
+    for (const ReplayEvent& event : m_Events)
+    {
+        WriteVarint(data, event.tick - previousTick);
+        previousTick = event.tick;
+        WriteU8(data, static_cast<uint8_t>(event.type));
+        WriteSigned(data, event.code);
+        if (event.type == ReplayEventType::MouseDown)
+        {
+            WriteSigned(data, event.x);
+            WriteSigned(data, event.y);
+            WriteU8(data, event.clicks);
+        }
+    }
+
+    std::ofstream outFile(path, std::ios::binary);
+    if (!outFile.is_open())
+    {
+        std::cerr << "Could not open replay file for writing: " << path << std::endl;
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return outFile.good();
+}
+
+bool Replay::LoadFromFile(const std::string& path)
+{
+    std::ifstream inFile(path, std::ios::binary);
+    if (!inFile.is_open())
+    {
+        std::cerr << "Could not open replay file for reading: " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+    Reader reader(data);
+    for (char c : g_Magic)
+    {
+        if (reader.ReadU8() != static_cast<uint8_t>(c))
+        {
+            std::cerr << "Not a replay file: " << path << std::endl;
+            return false;
+        }
+    }
+    uint16_t version = reader.ReadU8();
+    version |= static_cast<uint16_t>(reader.ReadU8() << 8);
+    if (version == 0 || version > g_Version)
+    {
+        std::cerr << "Unsupported replay version " << version << " in " << path << std::endl;
+        return false;
+    }
+
+    uint32_t seed = reader.ReadU32();
+    int tickRate = static_cast<int>(reader.ReadVarint());
+    float width = reader.ReadFloat();
+    float height = reader.ReadFloat();
+    Reset(seed, tickRate, width, height);
+    m_TickCount = reader.ReadU32();
+    if (version >= 2)
+    {
+        uint32_t stateSize = reader.ReadVarint();
+        for (uint32_t i = 0; i < stateSize && reader.IsOk(); ++i)
+        {
+            m_InitialState.push_back(reader.ReadU8());
+        }
+    }
+
+    uint32_t eventCount = reader.ReadVarint();
+    uint32_t tick = 0;
+    for (uint32_t i = 0; i < eventCount && reader.IsOk(); ++i)
+    {
+        ReplayEvent event{};
+        tick += reader.ReadVarint();
+        event.tick = tick;
+        event.type = static_cast<ReplayEventType>(reader.ReadU8());
+        event.code = reader.ReadSigned();
+        if (event.type == ReplayEventType::MouseDown)
+        {
+            event.x = reader.ReadSigned();
+            event.y = reader.ReadSigned();
+            event.clicks = reader.ReadU8();
+        }
+        m_Events.push_back(event);
+    }
+
+    if (!reader.IsOk() || tickRate <= 0)
+    {
+        std::cerr << "Replay file is truncated or corrupt: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ReplayEventType : uint8_t
+{
+    KeyDown,
+    KeyUp,
+    MouseDown
+};
+
+struct ReplayEvent
+{
+    uint32_t tick;          // simulation tick the event is applied before
+    ReplayEventType type;
+    int32_t code;           // SDL_Keycode for key events, mouse button for mouse events
+    int32_t x;
+    int32_t y;
+    uint8_t clicks;
+};
+
+// Recorded run: RNG seed, fixed tick rate, window size and every input event
+// stamped with the tick it was handled on. Stored as a small binary file with
+// delta-encoded ticks so long sessions stay compact.
+class Replay
+{
+public:
+    Replay();
+
+    void Reset(uint32_t seed, int tickRate, float width, float height);
+    void AddEvent(const ReplayEvent& event);
+    void SetTickCount(uint32_t tickCount) { m_TickCount = tickCount; }
+    void SetInitialState(const std::vector<uint8_t>& snapshot) { m_InitialState = snapshot; }
+
+    bool SaveToFile(const std::string& path) const;
+    bool LoadFromFile(const std::string& path);
+
+    uint32_t GetSeed() const { return m_Seed; }
+    int GetTickRate() const { return m_TickRate; }
+    float GetWidth() const { return m_Width; }
+    float GetHeight() const { return m_Height; }
+    uint32_t GetTickCount() const { return m_TickCount; }
+    const std::vector<ReplayEvent>& GetEvents() const { return m_Events; }
+    // Snapshot of the game the recording started from (empty for version 1 files)
+    const std::vector<uint8_t>& GetInitialState() const { return m_InitialState; }
+
+private:
+    uint32_t m_Seed;
+    int m_TickRate;
+    float m_Width;
+    float m_Height;
+    uint32_t m_TickCount;
+    std::vector<ReplayEvent> m_Events;
+    std::vector<uint8_t> m_InitialState;
+};
@@ -0,0 +1,238 @@
+#include "pch.h"
+#include "RewindBuffer.h"
+
+namespace
+{
+    void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    bool ReadVarint(const std::vector<uint8_t>& in, size_t& pos, uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7)
+        {
+            if (pos >= in.size()) return false;
+            uint8_t byte = in[pos++];
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t capacity, size_t memoryBudget, size_t keyframeInterval)
+    : m_Entries(capacity)
+    , m_Head(0)
+    , m_Count(0)
+    , m_MemoryBudget(memoryBudget)
+    , m_KeyframeInterval(keyframeInterval)
+    , m_SinceKeyframe(0)
+    , m_StoredBytes(0)
+    , m_RawBytes(0)
+{
+}
+
+void RewindBuffer::Push(const std::vector<uint8_t>& snapshot, int wave, bool isWaveStart)
+{
+    if (m_Entries.empty()) return;
+
+    // Wave starts are rewind targets of their own, so they always get a keyframe
+    bool isKeyframe = m_Count == 0 || isWaveStart || m_SinceKeyframe >= m_KeyframeInterval;
+
+    Entry entry;
+    entry.rawSize = static_cast<uint32_t>(snapshot.size());
+    entry.isKeyframe = isKeyframe;
+    entry.isWaveStart = isWaveStart;
+    entry.wave = wave;
+    if (isKeyframe)
+    {
+        entry.data = snapshot;
+        m_LastKeyframe = snapshot;
+        m_SinceKeyframe = 1;
+    }
+    else
+    {
+        EncodeDelta(m_LastKeyframe, snapshot, entry.data);
+        ++m_SinceKeyframe;
+    }
+
+    while (m_Count > 0 && (m_Count == m_Entries.size() || m_StoredBytes + entry.data.size() > m_MemoryBudget))
+    {
+        EvictOldestGroup();
+    }
+    // Evicting may have removed the keyframe this delta was encoded against
+    if (!entry.isKeyframe && m_Count == 0)
+    {
+        entry.data = snapshot;
+        entry.isKeyframe = true;
+        m_LastKeyframe = snapshot;
+        m_SinceKeyframe = 1;
+    }
+
+    m_StoredBytes += entry.data.size();
+    m_RawBytes += entry.rawSize;
+    m_Entries[(m_Head + m_Count) % m_Entries.size()] = std::move(entry);
+    ++m_Count;
+}
+
+bool RewindBuffer::Restore(size_t index, std::vector<uint8_t>& snapshot) const
+{
+    if (index >= m_Count) return false;
+
+    const Entry& entry = GetEntry(index);
+    if (entry.isKeyframe)
+    {
+        snapshot = entry.data;
+        return true;
+    }
+    const Entry& keyframe = GetEntry(FindKeyframe(index));
+    return DecodeDelta(keyframe.data, entry.data, entry.rawSize, snapshot);
+}
+
+void RewindBuffer::TruncateAfter(size_t index)
+{
+    while (m_Count > index + 1)
+    {
+        RemoveNewest();
+    }
+
+    // Continue delta encoding against the keyframe of the new newest entry
+    if (m_Count == 0)
+    {
+        m_LastKeyframe.clear();
+        m_SinceKeyframe = 0;
+        return;
+    }
+    size_t keyIndex = FindKeyframe(m_Count - 1);
+    m_LastKeyframe = GetEntry(keyIndex).data;
+    m_SinceKeyframe = m_Count - keyIndex;
+}
+
+void RewindBuffer::Clear()
+{
+    for (Entry& entry : m_Entries)
+    {
+        entry.data.clear();
+        entry.data.shrink_to_fit();
+    }
+    m_Head = 0;
+    m_Count = 0;
+    m_SinceKeyframe = 0;
+    m_StoredBytes = 0;
+    m_RawBytes = 0;
+    m_LastKeyframe.clear();
+}
+
+int RewindBuffer::FindWaveStart(int wave) const
+{
+    for (size_t i = m_Count; i-- > 0;)
+    {
+        const Entry& entry = GetEntry(i);
+        if (entry.wave == wave && entry.isWaveStart) return static_cast<int>(i);
+        if (entry.wave < wave) break;
+    }
+    return -1;
+}
+
+float RewindBuffer::GetCompressionRatio() const
+{
+    if (m_StoredBytes == 0) return 1.f;
+    return static_cast<float>(m_RawBytes) / static_cast<float>(m_StoredBytes);
+}
+
+const RewindBuffer::Entry& RewindBuffer::GetEntry(size_t index) const
+{
+    return m_Entries[(m_Head + index) % m_Entries.size()];
+}
+
+size_t RewindBuffer::FindKeyframe(size_t index) const
+{
+    while (index > 0 && !GetEntry(index).isKeyframe) --index;
+    return index;
+}
+
+void RewindBuffer::EvictOldestGroup()
+{
+    do
+    {
+        Entry& oldest = m_Entries[m_Head];
+        m_StoredBytes -= oldest.data.size();
+        m_RawBytes -= oldest.rawSize;
+        oldest.data.clear();
+        oldest.data.shrink_to_fit();
+        m_Head = (m_Head + 1) % m_Entries.size();
+        --m_Count;
+    } while (m_Count > 0 && !GetEntry(0).isKeyframe);
+}
+
+void RewindBuffer::RemoveNewest()
+{
+    Entry& newest = m_Entries[(m_Head + m_Count - 1) % m_Entries.size()];
+    m_StoredBytes -= newest.data.size();
+    m_RawBytes -= newest.rawSize;
+    newest.data.clear();
+    newest.data.shrink_to_fit();
+    --m_Count;
+}
+
+void RewindBuffer::EncodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& snapshot, std::vector<uint8_t>& delta)
+{
+    // Sequence of (zero run length, literal count, literal bytes) over snapshot ^ keyframe
+    delta.clear();
+    size_t pos = 0;
+    while (pos < snapshot.size())
+    {
+        size_t zeroStart = pos;
+        while (pos < snapshot.size() && pos < keyframe.size() && snapshot[pos] == keyframe[pos]) ++pos;
+        size_t literalStart = pos;
+        // End the literal run at the first stretch of 4 equal bytes
+        size_t equalRun = 0;
+        while (pos < snapshot.size() && equalRun < 4)
+        {
+            bool equal = pos < keyframe.size() && snapshot[pos] == keyframe[pos];
+            equalRun = equal ? equalRun + 1 : 0;
+            ++pos;
+        }
+        if (equalRun == 4) pos -= 4;
+
+        WriteVarint(delta, static_cast<uint32_t>(literalStart - zeroStart));
+        WriteVarint(delta, static_cast<uint32_t>(pos - literalStart));
+        for (size_t i = literalStart; i < pos; ++i)
+        {
+            uint8_t base = i < keyframe.size() ? keyframe[i] : 0;
+            delta.push_back(snapshot[i] ^ base);
+        }
+    }
+}
+
+bool RewindBuffer::DecodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& delta, uint32_t rawSize, std::vector<uint8_t>& snapshot)
+{
+    snapshot.assign(rawSize, 0);
+    size_t deltaPos = 0;
+    size_t pos = 0;
+    while (deltaPos < delta.size())
+    {
+        uint32_t zeroRun, literalCount;
+        if (!ReadVarint(delta, deltaPos, zeroRun) || !ReadVarint(delta, deltaPos, literalCount)) return false;
+        if (pos + zeroRun + literalCount > rawSize || deltaPos + literalCount > delta.size()) return false;
+        if (pos + zeroRun > keyframe.size()) return false;
+
+        for (uint32_t i = 0; i < zeroRun; ++i, ++pos)
+        {
+            snapshot[pos] = keyframe[pos];
+        }
+        for (uint32_t i = 0; i < literalCount; ++i, ++pos)
+        {
+            uint8_t base = pos < keyframe.size() ? keyframe[pos] : 0;
+            snapshot[pos] = delta[deltaPos++] ^ base;
+        }
+    }
+    return pos == rawSize;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Ring buffer of game snapshots for rewinding. Every Nth entry is stored as a
+// full keyframe, the entries in between only store their XOR difference to
+// that keyframe with runs of zero bytes collapsed. When the entry capacity or
+// memory budget is exceeded the oldest keyframe is evicted together with the
+// deltas that depend on it.
+class RewindBuffer
+{
+public:
+    RewindBuffer(size_t capacity, size_t memoryBudget, size_t keyframeInterval);
+
+    void Push(const std::vector<uint8_t>& snapshot, int wave, bool isWaveStart);
+    bool Restore(size_t index, std::vector<uint8_t>& snapshot) const;
+    // Drops every entry newer than index, so recording continues from there
+    void TruncateAfter(size_t index);
+    void Clear();
+
+    size_t GetCount() const { return m_Count; }
+    // Index of the entry recorded at the start of the given wave, -1 if evicted
+    int FindWaveStart(int wave) const;
+
+    size_t GetMemoryBudget() const { return m_MemoryBudget; }
+    size_t GetStoredBytes() const { return m_StoredBytes; }
+    size_t GetRawBytes() const { return m_RawBytes; }
+    float GetCompressionRatio() const;
+
+private:
+    struct Entry
+    {
+        std::vector<uint8_t> data;
+        uint32_t rawSize;
+        bool isKeyframe;
+        bool isWaveStart;
+        int wave;
+    };
+
+    const Entry& GetEntry(size_t index) const;
+    size_t FindKeyframe(size_t index) const;
+    void EvictOldestGroup();
+    void RemoveNewest();
+
+    static void EncodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& snapshot, std::vector<uint8_t>& delta);
+    static bool DecodeDelta(const std::vector<uint8_t>& keyframe, const std::vector<uint8_t>& delta, uint32_t rawSize, std::vector<uint8_t>& snapshot);
+
+    std::vector<Entry> m_Entries;
+    size_t m_Head;
+    size_t m_Count;
+    size_t m_MemoryBudget;
+    size_t m_KeyframeInterval;
+    size_t m_SinceKeyframe;
+    size_t m_StoredBytes;
+    size_t m_RawBytes;
+    std::vector<uint8_t> m_LastKeyframe;
+};
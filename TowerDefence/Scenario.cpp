@@ -0,0 +1,29 @@
+#include "pch.h"
+#include "Scenario.h"
+#include <iostream>
+
+namespace
+{
+    const Scenario g_Scenarios[]{
+        // name           description            melee  ranged bosses wave projectiles towers layout                  ricochet attackSpeed ticks
+        { "melee-rush",   "10k melee rush",      10000, 0,     0,     10,  0,          0,     ScenarioLayout::Edges, 0,       0.f,        600 },
+        { "ranged-ring",  "5k ranged ring",      0,     5000,  0,     10,  0,          0,     ScenarioLayout::Ring,  0,       0.f,        600 },
+        { "boss-bullets", "boss + 50k bullets",  0,     0,     1,     25,  50000,      0,     ScenarioLayout::Ring,  0,       0.f,        600 },
+        { "max-ricochet", "max ricochet",        3000,  1000,  0,     10,  0,          15,    ScenarioLayout::Edges, 20,      10.f,       600 },
+    };
+}
+
+const Scenario* Scenarios::Find(const std::string& name)
+{
+    for (const Scenario& scenario : g_Scenarios)
+    {
+        if (name == scenario.name) return &scenario;
+    }
+    return nullptr;
+}
+
+void Scenarios::Print(std::ostream& out)
+{
+    for (const Scenario& scenario : g_Scenarios)
+        out << "  " << scenario.name << ": " << scenario.description << std::endl;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+enum class ScenarioLayout : uint8_t
+{
+    // Random points just outside the window, like a normal wave
+    Edges,
+    // Evenly spaced rings around the main tower
+    Ring
+};
+
+// A named stress setup: a fixed horde, optionally a storm of enemy bullets
+// already in flight, and the tower upgrades to face it. Towers are immortal
+// and no waves run, so every tick measures the same load.
+struct Scenario
+{
+    const char* name;
+    const char* description;
+    int melee;
+    int ranged;
+    int bosses;
+    // Sets enemy health and speed and the bosses' power level, as in a normal wave
+    int wave;
+    // Bullets aimed at the main tower from all around it
+    int projectiles;
+    // Placed towers besides the main one
+    int towers;
+    ScenarioLayout layout;
+    // Added to every tower
+    int ricochet;
+    float attackSpeed;
+    int ticks;
+};
+
+namespace Scenarios
+{
+    // Null when no preset has that name
+    const Scenario* Find(const std::string& name);
+    // One line per preset: name and description
+    void Print(std::ostream& out);
+}
@@ -0,0 +1,174 @@
+#include "pch.h"
+#include "ScriptRuntime.h"
+#include "Snapshot.h"
+#include <algorithm>
+
+ScriptRuntime::ScriptRuntime(TimingWheel& timers)
+    : m_Timers{ timers }
+    , m_LastResumedCount{ 0 }
+{
+}
+
+void ScriptRuntime::Start(ScriptType type, uint32_t target)
+{
+    uint32_t index = 0;
+    if (!m_FreeFrames.empty())
+    {
+        index = m_FreeFrames.back();
+        m_FreeFrames.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_Frames.size());
+        m_Frames.push_back(ScriptFrame{});
+    }
+    m_Frames[index] = ScriptFrame{ type, true, 0, 0, target, ScriptAwait::Kind::Ready, 0 };
+    m_Ready.push_back(index);
+}
+
+void ScriptRuntime::Signal(ScriptEvent event)
+{
+    std::vector<uint32_t>& waiters = m_EventWaiters[static_cast<int>(event)];
+    for (uint32_t index : waiters)
+    {
+        ScriptFrame& frame = m_Frames[index];
+        if (!frame.live || frame.waitKind != ScriptAwait::Kind::Event || frame.waitValue != static_cast<uint32_t>(event)) continue;
+        frame.waitKind = ScriptAwait::Kind::Ready;
+        m_Ready.push_back(index);
+    }
+    waiters.clear();
+}
+
+void ScriptRuntime::StopAll()
+{
+    m_Frames.clear();
+    m_FreeFrames.clear();
+    m_Ready.clear();
+    m_Polling.clear();
+    for (std::vector<uint32_t>& waiters : m_EventWaiters)
+        waiters.clear();
+}
+
+void ScriptRuntime::CollectDue(ScriptType type, const std::vector<Timer>& dueTimers)
+{
+    m_Resuming.clear();
+    for (const Timer& timer : dueTimers)
+    {
+        if (timer.kind != TimerKind::Script || timer.target >= m_Frames.size()) continue;
+        ScriptFrame& frame = m_Frames[timer.target];
+        // Timers of stopped scripts whose frame was reused never match the wake tick
+        if (!frame.live || frame.type != type || frame.waitKind != ScriptAwait::Kind::Delay || frame.waitValue != timer.tick) continue;
+        frame.waitKind = ScriptAwait::Kind::Ready;
+        m_Resuming.push_back(timer.target);
+    }
+    TakeWaiting(m_Ready, type, ScriptAwait::Kind::Ready);
+    TakeWaiting(m_Polling, type, ScriptAwait::Kind::Condition);
+
+    std::sort(m_Resuming.begin(), m_Resuming.end());
+    m_Resuming.erase(std::unique(m_Resuming.begin(), m_Resuming.end()), m_Resuming.end());
+}
+
+void ScriptRuntime::TakeWaiting(std::vector<uint32_t>& list, ScriptType type, ScriptAwait::Kind waitKind)
+{
+    size_t kept = 0;
+    for (uint32_t index : list)
+    {
+        const ScriptFrame& frame = m_Frames[index];
+        if (!frame.live || frame.waitKind != waitKind) continue;
+        if (frame.type == type)
+            m_Resuming.push_back(index);
+        else
+            list[kept++] = index;
+    }
+    list.resize(kept);
+}
+
+void ScriptRuntime::Suspend(uint32_t index, const ScriptAwait& await)
+{
+    ScriptFrame& frame = m_Frames[index];
+    frame.waitKind = await.kind;
+    switch (await.kind)
+    {
+    case ScriptAwait::Kind::Ready:
+        m_Ready.push_back(index);
+        break;
+    case ScriptAwait::Kind::Delay:
+        frame.waitValue = m_Timers.GetTick() + std::max(1u, await.value);
+        m_Timers.Schedule(frame.waitValue, TimerKind::Script, index);
+        break;
+    case ScriptAwait::Kind::Event:
+        frame.waitValue = await.value;
+        m_EventWaiters[await.value].push_back(index);
+        break;
+    case ScriptAwait::Kind::Condition:
+        m_Polling.push_back(index);
+        break;
+    case ScriptAwait::Kind::Done:
+        frame.live = false;
+        m_FreeFrames.push_back(index);
+        break;
+    }
+}
+
+namespace
+{
+    void WriteIndices(SnapshotWriter& writer, const std::vector<uint32_t>& indices)
+    {
+        writer.WriteU32(static_cast<uint32_t>(indices.size()));
+        for (uint32_t index : indices) writer.WriteU32(index);
+    }
+
+    void ReadIndices(SnapshotReader& reader, std::vector<uint32_t>& indices, size_t frameCount)
+    {
+        indices.clear();
+        uint32_t count = reader.ReadU32();
+        for (uint32_t i = 0; i < count && reader.IsOk(); ++i)
+        {
+            uint32_t index = reader.ReadU32();
+            if (index < frameCount) indices.push_back(index);
+        }
+    }
+}
+
+void ScriptRuntime::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteU32(static_cast<uint32_t>(m_Frames.size()));
+    for (const ScriptFrame& frame : m_Frames)
+    {
+        writer.WriteU8(static_cast<uint8_t>(frame.type));
+        writer.WriteBool(frame.live);
+        writer.WriteInt(frame.step);
+        writer.WriteInt(frame.counter);
+        writer.WriteU32(frame.target);
+        writer.WriteU8(static_cast<uint8_t>(frame.waitKind));
+        writer.WriteU32(frame.waitValue);
+    }
+    WriteIndices(writer, m_FreeFrames);
+    WriteIndices(writer, m_Ready);
+    WriteIndices(writer, m_Polling);
+    for (const std::vector<uint32_t>& waiters : m_EventWaiters)
+        WriteIndices(writer, waiters);
+}
+
+void ScriptRuntime::ReadState(SnapshotReader& reader)
+{
+    StopAll();
+    uint32_t frameCount = reader.ReadU32();
+    for (uint32_t i = 0; i < frameCount && reader.IsOk(); ++i)
+    {
+        ScriptFrame frame{};
+        frame.type = static_cast<ScriptType>(reader.ReadU8());
+        frame.live = reader.ReadBool();
+        frame.step = reader.ReadInt();
+        frame.counter = reader.ReadInt();
+        frame.target = reader.ReadU32();
+        frame.waitKind = static_cast<ScriptAwait::Kind>(reader.ReadU8());
+        frame.waitValue = reader.ReadU32();
+        m_Frames.push_back(frame);
+    }
+    ReadIndices(reader, m_FreeFrames, m_Frames.size());
+    ReadIndices(reader, m_Ready, m_Frames.size());
+    ReadIndices(reader, m_Polling, m_Frames.size());
+    for (std::vector<uint32_t>& waiters : m_EventWaiters)
+        ReadIndices(reader, waiters, m_Frames.size());
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "TimingWheel.h"
+#include <cstdint>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// Which resume function runs a script: wave scripts are resumed by Game,
+// boss scripts by the BossBurst system
+enum class ScriptType : uint8_t
+{
+    Wave,
+    BossBurst
+};
+
+enum class ScriptEvent : uint8_t
+{
+    EnemyKilled,
+    Count
+};
+
+// What a script waits for when it returns
+struct ScriptAwait
+{
+    enum class Kind : uint8_t
+    {
+        Ready,
+        Delay,
+        Event,
+        Condition,
+        Done
+    };
+
+    Kind kind;
+    uint32_t value;
+
+    static ScriptAwait Delay(uint32_t ticks) { return ScriptAwait{ Kind::Delay, ticks }; }
+    static ScriptAwait Event(ScriptEvent event) { return ScriptAwait{ Kind::Event, static_cast<uint32_t>(event) }; }
+    // Resumed every tick until it returns something else
+    static ScriptAwait Condition() { return ScriptAwait{ Kind::Condition, 0 }; }
+    static ScriptAwait Done() { return ScriptAwait{ Kind::Done, 0 }; }
+};
+
+// A suspended script is nothing but this record: which step to continue at
+// and the few values it keeps across waits. That keeps scripts plain data, so
+// they go into snapshots and rewinds like everything else.
+struct ScriptFrame
+{
+    ScriptType type;
+    bool live;
+    int step;
+    int counter;
+    // Usually an EnemyHandle value
+    uint32_t target;
+    ScriptAwait::Kind waitKind;
+    // Wake tick or event, depending on waitKind
+    uint32_t waitValue;
+};
+
+// Runs resumable scripts written as a switch over frame.step: each call does
+// the work of one step, sets the step to continue at and returns what to wait
+// for. Frames live in one pool and are reused through a free list. Delays are
+// timers in the timing wheel and events keep their own waiting lists, so a
+// waiting script costs nothing until it is due; only conditions are polled.
+class ScriptRuntime
+{
+public:
+    explicit ScriptRuntime(TimingWheel& timers);
+    ScriptRuntime(const ScriptRuntime& other) = delete;
+    ScriptRuntime& operator=(const ScriptRuntime& other) = delete;
+
+    // The script first runs on the next Resume of its type
+    void Start(ScriptType type, uint32_t target);
+    // Wakes every script waiting for the event on the next Resume
+    void Signal(ScriptEvent event);
+    void StopAll();
+
+    // Calls resume(frame) for every script of the type that is due this tick,
+    // in frame order. Scripts started from inside resume wait for the next call.
+    template <typename ResumeFunction>
+    void Resume(ScriptType type, const std::vector<Timer>& dueTimers, ResumeFunction resume)
+    {
+        CollectDue(type, dueTimers);
+        for (uint32_t index : m_Resuming)
+        {
+            // A copy, since resume may start scripts and grow the pool
+            ScriptFrame frame = m_Frames[index];
+            ScriptAwait await = resume(frame);
+            m_Frames[index] = frame;
+            Suspend(index, await);
+        }
+        m_LastResumedCount += static_cast<uint32_t>(m_Resuming.size());
+    }
+
+    // Call once per tick before the Resume calls, for the statistics
+    void BeginTick() { m_LastResumedCount = 0; }
+
+    size_t GetLiveCount() const { return m_Frames.size() - m_FreeFrames.size(); }
+    size_t GetPoolSize() const { return m_Frames.size(); }
+    uint32_t GetLastResumedCount() const { return m_LastResumedCount; }
+
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+private:
+    void CollectDue(ScriptType type, const std::vector<Timer>& dueTimers);
+    void Suspend(uint32_t index, const ScriptAwait& await);
+    // Moves the entries of list whose frame is of the type and still waits
+    // with waitKind into m_Resuming; entries of other types stay
+    void TakeWaiting(std::vector<uint32_t>& list, ScriptType type, ScriptAwait::Kind waitKind);
+
+    TimingWheel& m_Timers;
+    std::vector<ScriptFrame> m_Frames;
+    std::vector<uint32_t> m_FreeFrames;
+    std::vector<uint32_t> m_Ready;
+    std::vector<uint32_t> m_Polling;
+    std::vector<uint32_t> m_EventWaiters[static_cast<int>(ScriptEvent::Count)];
+    std::vector<uint32_t> m_Resuming;
+    uint32_t m_LastResumedCount;
+};
@@ -0,0 +1,158 @@
+#include "pch.h"
+#include "Snapshot.h"
+#include <cstring>
+
+SnapshotWriter::SnapshotWriter(std::vector<uint8_t>& buffer)
+    : m_Buffer(buffer)
+{
+}
+
+void SnapshotWriter::WriteBytes(const void* pData, size_t size)
+{
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    m_Buffer.insert(m_Buffer.end(), pBytes, pBytes + size);
+}
+
+void SnapshotWriter::WriteU8(uint8_t value) { m_Buffer.push_back(value); }
+// Byte by byte, lowest first, so files match whatever the host's byte order
+void SnapshotWriter::WriteU32(uint32_t value)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    WriteBytes(bytes, sizeof(bytes));
+}
+
+void SnapshotWriter::WriteU64(uint64_t value)
+{
+    WriteU32(static_cast<uint32_t>(value));
+    WriteU32(static_cast<uint32_t>(value >> 32));
+}
+
+void SnapshotWriter::WriteInt(int value) { WriteU32(static_cast<uint32_t>(value)); }
+
+void SnapshotWriter::WriteFloat(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteU32(bits);
+}
+void SnapshotWriter::WriteBool(bool value) { WriteU8(value ? 1 : 0); }
+
+void SnapshotWriter::WriteString(const std::string& value)
+{
+    WriteU32(static_cast<uint32_t>(value.size()));
+    WriteBytes(value.data(), value.size());
+}
+
+void SnapshotWriter::WriteVector(const Vector2f& value)
+{
+    WriteFloat(value.x);
+    WriteFloat(value.y);
+}
+
+void SnapshotWriter::WriteEllipse(const Ellipsef& value)
+{
+    WriteVector(value.center);
+    WriteFloat(value.radiusX);
+    WriteFloat(value.radiusY);
+}
+
+void SnapshotWriter::WriteRect(const Rectf& value)
+{
+    WriteFloat(value.left);
+    WriteFloat(value.bottom);
+    WriteFloat(value.width);
+    WriteFloat(value.height);
+}
+
+SnapshotReader::SnapshotReader(const uint8_t* pData, size_t size)
+    : m_pData(pData)
+    , m_Size(size)
+    , m_Pos(0)
+    , m_Ok(true)
+{
+}
+
+void SnapshotReader::ReadBytes(void* pData, size_t size)
+{
+    if (!m_Ok || m_Size - m_Pos < size)
+    {
+        m_Ok = false;
+        std::memset(pData, 0, size);
+        return;
+    }
+    std::memcpy(pData, m_pData + m_Pos, size);
+    m_Pos += size;
+}
+
+uint8_t SnapshotReader::ReadU8()
+{
+    uint8_t value;
+    ReadBytes(&value, sizeof(value));
+    return value;
+}
+
+uint32_t SnapshotReader::ReadU32()
+{
+    uint8_t bytes[4];
+    ReadBytes(bytes, sizeof(bytes));
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    return value;
+}
+
+uint64_t SnapshotReader::ReadU64()
+{
+    uint64_t low = ReadU32();
+    uint64_t high = ReadU32();
+    return low | (high << 32);
+}
+
+int SnapshotReader::ReadInt() { return static_cast<int>(ReadU32()); }
+
+float SnapshotReader::ReadFloat()
+{
+    uint32_t bits = ReadU32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool SnapshotReader::ReadBool() { return ReadU8() != 0; }
+
+std::string SnapshotReader::ReadString()
+{
+    uint32_t size = ReadU32();
+    if (!m_Ok || m_Size - m_Pos < size)
+    {
+        m_Ok = false;
+        return std::string{};
+    }
+    std::string value(reinterpret_cast<const char*>(m_pData + m_Pos), size);
+    m_Pos += size;
+    return value;
+}
+
+Vector2f SnapshotReader::ReadVector()
+{
+    float x = ReadFloat();
+    float y = ReadFloat();
+    return Vector2f{ x, y };
+}
+
+Ellipsef SnapshotReader::ReadEllipse()
+{
+    Vector2f center = ReadVector();
+    float radiusX = ReadFloat();
+    float radiusY = ReadFloat();
+    return Ellipsef{ center, radiusX, radiusY };
+}
+
+Rectf SnapshotReader::ReadRect()
+{
+    float left = ReadFloat();
+    float bottom = ReadFloat();
+    float width = ReadFloat();
+    float height = ReadFloat();
+    return Rectf{ left, bottom, width, height };
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "structs.h"
+
+// Flat little-endian serialization used for save states, rewind and state
+// hashing. Values are written back to back without tags; the reader must
+// consume them in exactly the order they were written.
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& buffer);
+
+    void WriteU8(uint8_t value);
+    void WriteU32(uint32_t value);
+    void WriteU64(uint64_t value);
+    void WriteInt(int value);
+    void WriteFloat(float value);
+    void WriteBool(bool value);
+    void WriteString(const std::string& value);
+    void WriteVector(const Vector2f& value);
+    void WriteEllipse(const Ellipsef& value);
+    void WriteRect(const Rectf& value);
+
+private:
+    void WriteBytes(const void* pData, size_t size);
+
+    std::vector<uint8_t>& m_Buffer;
+};
+
+class SnapshotReader
+{
+public:
+    SnapshotReader(const uint8_t* pData, size_t size);
+
+    // False once any read ran past the end of the data or Fail was called
+    bool IsOk() const { return m_Ok; }
+    // For data that reads fine but makes no sense, e.g. an index out of range
+    void Fail() { m_Ok = false; }
+    bool IsAtEnd() const { return m_Pos == m_Size; }
+
+    uint8_t ReadU8();
+    uint32_t ReadU32();
+    uint64_t ReadU64();
+    int ReadInt();
+    float ReadFloat();
+    bool ReadBool();
+    std::string ReadString();
+    Vector2f ReadVector();
+    Ellipsef ReadEllipse();
+    Rectf ReadRect();
+
+private:
+    void ReadBytes(void* pData, size_t size);
+
+    const uint8_t* m_pData;
+    size_t m_Size;
+    size_t m_Pos;
+    bool m_Ok;
+};
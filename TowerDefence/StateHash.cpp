@@ -0,0 +1,94 @@
+#include "pch.h"
+#include "StateHash.h"
+#include <iostream>
+#include <iomanip>
+
+namespace
+{
+    const uint64_t g_FnvOffset{ 0xCBF29CE484222325ull };
+    const uint64_t g_FnvPrime{ 0x100000001B3ull };
+
+    bool ReadRecord(std::ifstream& file, uint32_t& tick, uint64_t& hash)
+    {
+        unsigned char buffer[12];
+        if (!file.read(reinterpret_cast<char*>(buffer), sizeof(buffer))) return false;
+        tick = 0;
+        hash = 0;
+        for (int i = 0; i < 4; ++i) tick |= static_cast<uint32_t>(buffer[i]) << (i * 8);
+        for (int i = 0; i < 8; ++i) hash |= static_cast<uint64_t>(buffer[4 + i]) << (i * 8);
+        return true;
+    }
+}
+
+StateHash::StateHash()
+    : m_Value(g_FnvOffset)
+{
+}
+
+void StateHash::AddBytes(const void* pData, size_t size)
+{
+    const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+    for (size_t i = 0; i < size; ++i)
+    {
+        m_Value ^= pBytes[i];
+        m_Value *= g_FnvPrime;
+    }
+}
+
+bool StateHashLog::Open(const std::string& path)
+{
+    m_File.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_File.is_open())
+    {
+        std::cerr << "Could not open hash log for writing: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void StateHashLog::Write(uint32_t tick, uint64_t hash)
+{
+    unsigned char buffer[12];
+    for (int i = 0; i < 4; ++i) buffer[i] = static_cast<unsigned char>(tick >> (i * 8));
+    for (int i = 0; i < 8; ++i) buffer[4 + i] = static_cast<unsigned char>(hash >> (i * 8));
+    m_File.write(reinterpret_cast<const char*>(buffer), sizeof(buffer));
+}
+
+bool StateHashLog::Compare(const std::string& pathA, const std::string& pathB)
+{
+    std::ifstream fileA(pathA, std::ios::binary);
+    std::ifstream fileB(pathB, std::ios::binary);
+    if (!fileA.is_open() || !fileB.is_open())
+    {
+        std::cerr << "Could not open hash logs " << pathA << " and " << pathB << std::endl;
+        return false;
+    }
+
+    uint32_t tickA, tickB;
+    uint64_t hashA, hashB;
+    uint32_t records = 0;
+    while (true)
+    {
+        bool hasA = ReadRecord(fileA, tickA, hashA);
+        bool hasB = ReadRecord(fileB, tickB, hashB);
+        if (!hasA && !hasB)
+        {
+            std::cout << "Hash logs match (" << records << " ticks)" << std::endl;
+            return true;
+        }
+        if (hasA != hasB)
+        {
+            std::cout << "Hash logs match for " << records << " ticks, then "
+                << (hasA ? pathB : pathA) << " ends" << std::endl;
+            return false;
+        }
+        if (tickA != tickB || hashA != hashB)
+        {
+            std::cout << "First divergence at tick " << tickA << ": "
+                << std::hex << std::setw(16) << std::setfill('0') << hashA << " vs "
+                << std::setw(16) << hashB << std::dec << std::setfill(' ') << std::endl;
+            return false;
+        }
+        ++records;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// 64-bit FNV-1a hash over the canonical simulation state, which is the
+// serialized snapshot of the game. Floats are hashed by bit pattern, so any
+// change in simulation results, however small, changes the hash.
+class StateHash
+{
+public:
+    StateHash();
+
+    void AddBytes(const void* pData, size_t size);
+    uint64_t GetValue() const { return m_Value; }
+
+private:
+    uint64_t m_Value;
+};
+
+// Binary stream of (tick, hash) records, one per simulation tick.
+class StateHashLog
+{
+public:
+    bool Open(const std::string& path);
+    void Write(uint32_t tick, uint64_t hash);
+    bool IsOpen() const { return m_File.is_open(); }
+
+    // Compares two logs and prints the first tick on which they differ.
+    // Returns true when both logs are identical.
+    static bool Compare(const std::string& pathA, const std::string& pathB);
+
+private:
+    std::ofstream m_File;
+};
@@ -0,0 +1,197 @@
+#include "pch.h"
+#include "StatusEffects.h"
+#include "EnemyWorld.h"
+#include "Snapshot.h"
+#include "CircleRenderer.h"
+#include <algorithm>
+
+namespace
+{
+    const Color4f g_StatusColors[]{
+        Color4f(0.4f, 0.7f, 1.f, 0.9f),  // Slow
+        Color4f(1.f, 0.45f, 0.1f, 0.9f), // Burn
+        Color4f(0.4f, 0.9f, 0.2f, 0.9f), // Poison
+        Color4f(1.f, 1.f, 0.3f, 0.9f),   // Stun
+    };
+
+    // The archetype and row of a live target, null when it is gone
+    EnemyArchetype* Find(EnemyWorld& world, uint32_t target, size_t& row)
+    {
+        EnemyHandle handle;
+        handle.value = target;
+        EnemyType type;
+        if (!world.Locate(handle, type, row)) return nullptr;
+        return &world.GetArchetype(type);
+    }
+}
+
+StatusEffects::StatusEffects()
+{
+}
+
+void StatusEffects::Apply(StatusType type, EnemyHandle target, float duration, float magnitude, float maxMagnitude)
+{
+    Column& column = m_Columns[static_cast<int>(type)];
+    const uint32_t index = target.GetIndex();
+    if (index >= column.lookup.size()) column.lookup.resize(index + 1, 0);
+
+    uint32_t& slot = column.lookup[index];
+    // The slot may still hold an effect of a dead enemy that used the same
+    // handle index; it is taken over as if new
+    if (slot != 0 && column.targets[slot - 1] == target.value)
+    {
+        size_t effect = slot - 1;
+        column.remaining[effect] = std::max(column.remaining[effect], duration);
+        if (type == StatusType::Poison)
+            column.magnitudes[effect] = std::min(column.magnitudes[effect] + magnitude, maxMagnitude);
+        else
+            column.magnitudes[effect] = std::max(column.magnitudes[effect], magnitude);
+        return;
+    }
+    if (slot != 0)
+    {
+        size_t effect = slot - 1;
+        column.targets[effect] = target.value;
+        column.remaining[effect] = duration;
+        column.magnitudes[effect] = magnitude;
+        return;
+    }
+    column.targets.push_back(target.value);
+    column.remaining.push_back(duration);
+    column.magnitudes.push_back(magnitude);
+    slot = static_cast<uint32_t>(column.targets.size());
+}
+
+void StatusEffects::Remove(Column& column, size_t index)
+{
+    column.lookup[column.targets[index] & EnemyHandle::IndexMask] = 0;
+    const size_t last = column.targets.size() - 1;
+    if (index != last)
+    {
+        column.targets[index] = column.targets[last];
+        column.remaining[index] = column.remaining[last];
+        column.magnitudes[index] = column.magnitudes[last];
+        column.lookup[column.targets[index] & EnemyHandle::IndexMask] = static_cast<uint32_t>(index + 1);
+    }
+    column.targets.pop_back();
+    column.remaining.pop_back();
+    column.magnitudes.pop_back();
+}
+
+void StatusEffects::Update(EnemyWorld& world, float elapsedSec)
+{
+    // Speed scales are rebuilt from the slows and stuns still running, so an
+    // enemy whose last one runs out this tick walks at full speed again
+    for (StatusType type : { StatusType::Slow, StatusType::Stun })
+    {
+        for (uint32_t target : m_Columns[static_cast<int>(type)].targets)
+        {
+            size_t row = 0;
+            if (EnemyArchetype* pArchetype = Find(world, target, row))
+                pArchetype->movements[row].speedScale = 1.f;
+        }
+    }
+
+    for (int type = 0; type < TypeCount; ++type)
+    {
+        Column& column = m_Columns[type];
+        const bool damages = type == static_cast<int>(StatusType::Burn) || type == static_cast<int>(StatusType::Poison);
+        for (size_t i = 0; i < column.targets.size(); )
+        {
+            size_t row = 0;
+            EnemyArchetype* pArchetype = Find(world, column.targets[i], row);
+            if (pArchetype && damages)
+            {
+                HealthComponent& health = pArchetype->healths[row];
+                float seconds = std::min(elapsedSec, column.remaining[i]);
+                health.health = std::max(0.f, health.health - column.magnitudes[i] * seconds);
+            }
+            column.remaining[i] -= elapsedSec;
+            if (!pArchetype || column.remaining[i] <= 0.f)
+            {
+                // The last effect moves into this one, so i is looked at again
+                Remove(column, i);
+                continue;
+            }
+            if (type == static_cast<int>(StatusType::Slow))
+            {
+                float& scale = pArchetype->movements[row].speedScale;
+                scale = std::min(scale, 1.f - column.magnitudes[i]);
+            }
+            else if (type == static_cast<int>(StatusType::Stun))
+            {
+                pArchetype->movements[row].speedScale = 0.f;
+            }
+            ++i;
+        }
+    }
+}
+
+size_t StatusEffects::GetActiveCount() const
+{
+    size_t count = 0;
+    for (const Column& column : m_Columns) count += column.targets.size();
+    return count;
+}
+
+void StatusEffects::Draw(const EnemyWorld& world, CircleRenderer& circles) const
+{
+    for (int type = 0; type < TypeCount; ++type)
+    {
+        for (uint32_t target : m_Columns[type].targets)
+        {
+            EnemyHandle handle;
+            handle.value = target;
+            const TransformComponent* pTransform = world.FindTransform(handle);
+            if (!pTransform) continue;
+            const Ellipsef& shape = pTransform->shape;
+            float grow = 3.f + 3.f * type;
+            circles.Outline(shape.center, shape.radiusX + grow, shape.radiusY + grow, g_StatusColors[type], 1.5f);
+        }
+    }
+    circles.Flush();
+}
+
+void StatusEffects::Clear()
+{
+    for (Column& column : m_Columns)
+    {
+        column.targets.clear();
+        column.remaining.clear();
+        column.magnitudes.clear();
+        column.lookup.clear();
+    }
+}
+
+void StatusEffects::WriteState(SnapshotWriter& writer) const
+{
+    for (const Column& column : m_Columns)
+    {
+        writer.WriteU32(static_cast<uint32_t>(column.targets.size()));
+        for (size_t i = 0; i < column.targets.size(); ++i)
+        {
+            writer.WriteU32(column.targets[i]);
+            writer.WriteFloat(column.remaining[i]);
+            writer.WriteFloat(column.magnitudes[i]);
+        }
+    }
+}
+
+void StatusEffects::ReadState(SnapshotReader& reader)
+{
+    Clear();
+    for (Column& column : m_Columns)
+    {
+        uint32_t count = reader.ReadU32();
+        for (uint32_t i = 0; i < count && reader.IsOk(); ++i)
+        {
+            uint32_t target = reader.ReadU32();
+            column.targets.push_back(target);
+            column.remaining.push_back(reader.ReadFloat());
+            column.magnitudes.push_back(reader.ReadFloat());
+            uint32_t index = target & EnemyHandle::IndexMask;
+            if (index >= column.lookup.size()) column.lookup.resize(index + 1, 0);
+            column.lookup[index] = i + 1;
+        }
+    }
+}
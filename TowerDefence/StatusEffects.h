@@ -0,0 +1,67 @@
+#pragma once
+#include "EnemyHandle.h"
+#include <vector>
+#include <cstdint>
+
+class EnemyWorld;
+class CircleRenderer;
+class SnapshotWriter;
+class SnapshotReader;
+
+enum class StatusType : uint8_t
+{
+    // Walking speed drops by the magnitude, a fraction
+    Slow,
+    // Magnitude is damage per second
+    Burn,
+    // Damage per second that grows with every application up to a cap
+    Poison,
+    // No walking and no attacks; bosses are immune
+    Stun,
+    Count
+};
+
+// Active slows, burns, poisons and stuns. Each type keeps its effects in
+// three packed columns (target, seconds left, magnitude), at most one per
+// enemy, so an effect costs twelve bytes plus a lookup slot per handle index.
+// Update runs one kernel per type over its own columns, so the cost grows
+// with the number of active effects, not with the number of enemies.
+class StatusEffects
+{
+public:
+    StatusEffects();
+    StatusEffects(const StatusEffects& other) = delete;
+    StatusEffects& operator=(const StatusEffects& other) = delete;
+
+    // Reapplying keeps the longer duration and the stronger magnitude;
+    // poison adds the magnitude instead, up to maxMagnitude
+    void Apply(StatusType type, EnemyHandle target, float duration, float magnitude, float maxMagnitude = 0.f);
+    // Damage over time, speed scales and expiry; effects on dead enemies are dropped
+    void Update(EnemyWorld& world, float elapsedSec);
+
+    size_t GetActiveCount(StatusType type) const { return m_Columns[static_cast<int>(type)].targets.size(); }
+    size_t GetActiveCount() const;
+
+    // A ring per effect around the enemy carrying it
+    void Draw(const EnemyWorld& world, CircleRenderer& circles) const;
+    void Clear();
+
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+private:
+    static const int TypeCount{ static_cast<int>(StatusType::Count) };
+
+    struct Column
+    {
+        std::vector<uint32_t> targets;
+        std::vector<float> remaining;
+        std::vector<float> magnitudes;
+        // Position + 1 of the effect on each handle index, 0 for none
+        std::vector<uint32_t> lookup;
+    };
+
+    void Remove(Column& column, size_t index);
+
+    Column m_Columns[TypeCount];
+};
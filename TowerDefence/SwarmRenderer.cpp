@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "SwarmRenderer.h"
+#include "EnemyWorld.h"
+#include "EnemySystems.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Swarming starts at this many melee and ranged enemies and stops again
+    // below the lower count
+    const size_t g_SwarmEnterCount{ 500 };
+    const size_t g_SwarmLeaveCount{ 350 };
+    // Or at this many crowded cells, e.g. a smaller horde piled onto one tower
+    const int g_SwarmEnterCrowdedCells{ 8 };
+    const int g_SwarmLeaveCrowdedCells{ 4 };
+    // Smaller hordes are always drawn in full and not even binned
+    const size_t g_MinBinnedCount{ 150 };
+
+    const float g_CellSize{ 48.f };
+    // A cell with this many enemies is drawn as a blob
+    const int g_BlobCount{ 6 };
+    // Blob diameters by how many enemies they stand for, one draw each
+    const struct BlobSize
+    {
+        int maxCount;
+        float diameter;
+    } g_BlobSizes[]{
+        { 10, 30.f },
+        { 20, 40.f },
+        { 40, 52.f },
+        { std::numeric_limits<int>::max(), 64.f },
+    };
+    const float g_BlobAlpha{ 0.85f };
+
+    // Body colour, with the red of powered-up melee enemies
+    Color4f GetSwarmColor(const EnemyArchetype& archetype, size_t row)
+    {
+        const RenderStyleComponent& style = archetype.renderStyles[row];
+        if (archetype.type == EnemyType::Melee && style.powerLevel > 1) return Color4f(1.f, 0.2f, 0.3f, 1.f);
+        return style.bodyColor;
+    }
+}
+
+SwarmRenderer::SwarmRenderer()
+    : m_Columns{ 0 }
+    , m_Rows{ 0 }
+    , m_Swarming{ false }
+    , m_SpriteCount{ 0 }
+    , m_BlobCount{ 0 }
+    , m_LastDrawMicroseconds{ 0.f }
+{
+}
+
+void SwarmRenderer::Draw(const EnemyWorld& world, CircleRenderer& circles, float windowWidth, float windowHeight) const
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const EnemyArchetype& melee = world.GetArchetype(EnemyType::Melee);
+    const EnemyArchetype& ranged = world.GetArchetype(EnemyType::Ranged);
+    const size_t count = melee.Size() + ranged.Size();
+
+    int crowdedCells = 0;
+    if (count >= g_MinBinnedCount)
+    {
+        m_Columns = std::max(1, static_cast<int>(std::ceil(windowWidth / g_CellSize)));
+        m_Rows = std::max(1, static_cast<int>(std::ceil(windowHeight / g_CellSize)));
+        m_Cells.assign(m_Columns * m_Rows, Cell{});
+        crowdedCells = Bin(melee) + Bin(ranged);
+    }
+    if (m_Swarming)
+        m_Swarming = count >= g_SwarmLeaveCount || crowdedCells >= g_SwarmLeaveCrowdedCells;
+    else
+        m_Swarming = count >= g_SwarmEnterCount || crowdedCells >= g_SwarmEnterCrowdedCells;
+
+    m_SpriteCount = 0;
+    m_BlobCount = 0;
+    if (!m_Swarming)
+    {
+        EnemySystems::Draw(world, circles);
+    }
+    else
+    {
+        glEnable(GL_POINT_SMOOTH);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        DrawBlobs();
+        DrawSprites(melee);
+        DrawSprites(ranged);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        glDisable(GL_POINT_SMOOTH);
+        EnemySystems::DrawBosses(world, circles);
+        world.GetProjectiles().Draw();
+    }
+    m_LastDrawMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t SwarmRenderer::GetCellIndex(const Vector2f& position) const
+{
+    // Enemies still walking in from outside the window count towards the edge cells
+    int column = std::min(std::max(static_cast<int>(position.x / g_CellSize), 0), m_Columns - 1);
+    int row = std::min(std::max(static_cast<int>(position.y / g_CellSize), 0), m_Rows - 1);
+    return static_cast<size_t>(row) * m_Columns + column;
+}
+
+int SwarmRenderer::Bin(const EnemyArchetype& archetype) const
+{
+    int crowded = 0;
+    for (size_t row = 0; row < archetype.Size(); ++row)
+    {
+        const Vector2f center = EnemySystems::GetDrawShape(archetype, row).center;
+        const Color4f color = GetSwarmColor(archetype, row);
+        Cell& cell = m_Cells[GetCellIndex(center)];
+        cell.x += center.x;
+        cell.y += center.y;
+        cell.red += color.r;
+        cell.green += color.g;
+        cell.blue += color.b;
+        if (++cell.count == g_BlobCount) ++crowded;
+    }
+    return crowded;
+}
+
+void SwarmRenderer::DrawSprites(const EnemyArchetype& archetype) const
+{
+    if (archetype.Size() == 0) return;
+    m_Vertices.clear();
+    m_Colors.clear();
+    for (size_t row = 0; row < archetype.Size(); ++row)
+    {
+        const Vector2f center = EnemySystems::GetDrawShape(archetype, row).center;
+        if (m_Cells[GetCellIndex(center)].count >= g_BlobCount) continue;
+        const Color4f color = GetSwarmColor(archetype, row);
+        m_Vertices.push_back(center.x);
+        m_Vertices.push_back(center.y);
+        m_Colors.push_back(color.r);
+        m_Colors.push_back(color.g);
+        m_Colors.push_back(color.b);
+        m_Colors.push_back(color.a);
+    }
+    // Every enemy of an archetype has the same size
+    DrawPoints(archetype.transforms[0].shape.radiusX * 2.f);
+    m_SpriteCount += m_Vertices.size() / 2;
+}
+
+void SwarmRenderer::DrawBlobs() const
+{
+    int minCount = g_BlobCount;
+    for (const BlobSize& size : g_BlobSizes)
+    {
+        m_Vertices.clear();
+        m_Colors.clear();
+        for (const Cell& cell : m_Cells)
+        {
+            if (cell.count < minCount || cell.count > size.maxCount) continue;
+            const float scale = 1.f / cell.count;
+            m_Vertices.push_back(cell.x * scale);
+            m_Vertices.push_back(cell.y * scale);
+            m_Colors.push_back(cell.red * scale);
+            m_Colors.push_back(cell.green * scale);
+            m_Colors.push_back(cell.blue * scale);
+            m_Colors.push_back(g_BlobAlpha);
+        }
+        DrawPoints(size.diameter);
+        m_BlobCount += m_Vertices.size() / 2;
+        minCount = size.maxCount + 1;
+    }
+}
+
+void SwarmRenderer::DrawPoints(float size) const
+{
+    if (m_Vertices.empty()) return;
+    glPointSize(size);
+    glVertexPointer(2, GL_FLOAT, 0, m_Vertices.data());
+    glColorPointer(4, GL_FLOAT, 0, m_Colors.data());
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(m_Vertices.size() / 2));
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+
+class EnemyWorld;
+class CircleRenderer;
+struct EnemyArchetype;
+
+// Draw level of detail for the enemy horde. Up to a few hundred enemies
+// are drawn in full by EnemySystems::Draw. Past a count or density
+// threshold the swarm is binned into a coarse screen grid instead: crowded
+// cells become one blob each, and the enemies in the other cells become
+// round points in one batched draw per archetype, without health bars,
+// glows or range rings. Bosses are always drawn in full. A cell only
+// holds a few points before it turns into a blob, so what is sent to the
+// GPU is bounded by the grid size, not by the horde size.
+class SwarmRenderer
+{
+public:
+    SwarmRenderer();
+    SwarmRenderer(const SwarmRenderer& other) = delete;
+    SwarmRenderer& operator=(const SwarmRenderer& other) = delete;
+
+    void Draw(const EnemyWorld& world, CircleRenderer& circles, float windowWidth, float windowHeight) const;
+
+    bool IsSwarming() const { return m_Swarming; }
+    size_t GetSpriteCount() const { return m_SpriteCount; }
+    size_t GetBlobCount() const { return m_BlobCount; }
+    float GetLastDrawMicroseconds() const { return m_LastDrawMicroseconds; }
+
+private:
+    struct Cell
+    {
+        int count;
+        // Sums of member positions and colours, for the blob's centre and tint
+        float x;
+        float y;
+        float red;
+        float green;
+        float blue;
+    };
+
+    size_t GetCellIndex(const Vector2f& position) const;
+    // Adds the archetype's enemies to the cells and returns how many cells
+    // it made crowded
+    int Bin(const EnemyArchetype& archetype) const;
+    // The enemies outside crowded cells, one batch
+    void DrawSprites(const EnemyArchetype& archetype) const;
+    // One batch per blob size
+    void DrawBlobs() const;
+    // Draws the vertex and colour buffers as round points
+    void DrawPoints(float size) const;
+
+    mutable int m_Columns;
+    mutable int m_Rows;
+    mutable std::vector<Cell> m_Cells;
+    mutable std::vector<float> m_Vertices;
+    mutable std::vector<float> m_Colors;
+    // Switching back to full detail waits for a lower count, so a horde
+    // hovering around the threshold does not flicker between the two
+    mutable bool m_Swarming;
+    mutable size_t m_SpriteCount;
+    mutable size_t m_BlobCount;
+    mutable float m_LastDrawMicroseconds;
+};
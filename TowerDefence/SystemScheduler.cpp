@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "SystemScheduler.h"
+#include <chrono>
+
+SystemScheduler::SystemScheduler()
+    : m_StageCount(0)
+{
+}
+
+void SystemScheduler::AddSystem(const std::string& name, ComponentMask reads, ComponentMask writes, SystemFunction function)
+{
+    System system{ name, reads, writes, function, 0, 0.f };
+
+    // A system has to run after every earlier system it shares mutable data with
+    for (const System& other : m_Systems)
+    {
+        if (Conflicts(system, other))
+            system.stage = std::max(system.stage, other.stage + 1);
+    }
+    m_StageCount = std::max(m_StageCount, system.stage + 1);
+    m_Systems.push_back(system);
+}
+
+void SystemScheduler::Run(EnemyWorld& world, SimulationContext& context)
+{
+    for (int stage = 0; stage < m_StageCount; ++stage)
+    {
+        for (System& system : m_Systems)
+        {
+            if (system.stage != stage) continue;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            system.function(world, context);
+            system.lastMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+}
+
+bool SystemScheduler::Conflicts(const System& a, const System& b)
+{
+    return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+}
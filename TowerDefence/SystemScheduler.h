@@ -0,0 +1,41 @@
+#pragma once
+#include "EnemyComponents.h"
+#include <string>
+#include <vector>
+
+class EnemyWorld;
+struct SimulationContext;
+
+// Runs the enemy systems once per tick. Every system declares the components
+// it reads and writes; systems are grouped into stages so that no two systems
+// in a stage touch the same data mutably. Stages run in order, keeping the
+// result identical to running the systems in registration order.
+class SystemScheduler
+{
+public:
+    using SystemFunction = void (*)(EnemyWorld& world, SimulationContext& context);
+
+    struct System
+    {
+        std::string name;
+        ComponentMask reads;
+        ComponentMask writes;
+        SystemFunction function;
+        int stage;
+        float lastMicroseconds;
+    };
+
+    SystemScheduler();
+
+    void AddSystem(const std::string& name, ComponentMask reads, ComponentMask writes, SystemFunction function);
+    void Run(EnemyWorld& world, SimulationContext& context);
+
+    const std::vector<System>& GetSystems() const { return m_Systems; }
+    int GetStageCount() const { return m_StageCount; }
+
+private:
+    static bool Conflicts(const System& a, const System& b);
+
+    std::vector<System> m_Systems;
+    int m_StageCount;
+};
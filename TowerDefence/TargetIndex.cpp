@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "TargetIndex.h"
+#include "EnemyWorld.h"
+#include "EnemyGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Heap order with the best candidate on top; distance and then the handle
+    // break ties, e.g. between enemies that all still have full health
+    bool IsWorse(const TargetIndex::Candidate& a, const TargetIndex::Candidate& b)
+    {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.distance != b.distance) return a.distance > b.distance;
+        return a.handle.value > b.handle.value;
+    }
+}
+
+TargetIndex::TargetIndex()
+    : m_Current{}
+    , m_HasCurrent{ false }
+{
+}
+
+void TargetIndex::Build(const EnemyWorld& enemies, const EnemyGrid& grid, const Vector2f& center, float range,
+    TargetingPolicy policy, EnemyHandle current)
+{
+    m_Heap.clear();
+    m_HasCurrent = false;
+
+    grid.Query(center, range, [&](const EnemyGrid::Entry& entry) {
+        float dx = entry.position.x - center.x;
+        float dy = entry.position.y - center.y;
+        float distance = std::sqrt(dx * dx + dy * dy);
+        if (distance > range) return;
+
+        const EnemyArchetype& archetype = enemies.GetArchetype(entry.type);
+        const HealthComponent& health = archetype.healths[entry.row];
+        if (health.health <= 0.f) return;
+
+        float speed = archetype.movements[entry.row].speed;
+        Candidate candidate{};
+        candidate.handle = archetype.handles[entry.row];
+        candidate.position = entry.position;
+        candidate.distance = distance;
+        candidate.healthFraction = health.maxHealth > 0.f ? health.health / health.maxHealth : 1.f;
+        candidate.arrivalTime = speed > 0.f ? distance / speed : std::numeric_limits<float>::max();
+        candidate.isBoss = entry.type == EnemyType::Boss;
+        candidate.score = Score(policy, candidate);
+        m_Heap.push_back(candidate);
+        if (!current.IsNull() && candidate.handle == current)
+        {
+            m_Current = candidate;
+            m_HasCurrent = true;
+        }
+    });
+
+    std::make_heap(m_Heap.begin(), m_Heap.end(), IsWorse);
+}
+
+const TargetIndex::Candidate* TargetIndex::Select() const
+{
+    return m_Heap.empty() ? nullptr : &m_Heap.front();
+}
+
+const TargetIndex::Candidate* TargetIndex::GetCurrent() const
+{
+    return m_HasCurrent ? &m_Current : nullptr;
+}
+
+float TargetIndex::Score(TargetingPolicy policy, const Candidate& candidate)
+{
+    switch (policy)
+    {
+    case TargetingPolicy::First:
+        return candidate.arrivalTime;
+    case TargetingPolicy::Strongest:
+        return -candidate.healthFraction;
+    case TargetingPolicy::Weakest:
+        return candidate.healthFraction;
+    case TargetingPolicy::BossFirst:
+        // Any boss beats any regular enemy, distance decides within each group
+        return candidate.isBoss ? candidate.distance - 100000.f : candidate.distance;
+    case TargetingPolicy::Nearest:
+    default:
+        return candidate.distance;
+    }
+}
+
+bool TargetIndex::IsClearlyBetter(TargetingPolicy policy, const Candidate& candidate, const Candidate& current,
+    float margin)
+{
+    switch (policy)
+    {
+    case TargetingPolicy::First:
+        return candidate.arrivalTime < current.arrivalTime * (1.f - margin);
+    case TargetingPolicy::Strongest:
+        return candidate.healthFraction > current.healthFraction + margin;
+    case TargetingPolicy::Weakest:
+        return candidate.healthFraction < current.healthFraction - margin;
+    case TargetingPolicy::BossFirst:
+        // Switching between a boss and a regular enemy needs no margin
+        if (candidate.isBoss != current.isBoss) return candidate.isBoss;
+        return candidate.distance < current.distance * (1.f - margin);
+    case TargetingPolicy::Nearest:
+    default:
+        return candidate.distance < current.distance * (1.f - margin);
+    }
+}
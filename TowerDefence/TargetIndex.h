@@ -0,0 +1,56 @@
+#pragma once
+#include "structs.h"
+#include "EnemyHandle.h"
+#include "TargetingPolicy.h"
+#include <vector>
+
+class EnemyWorld;
+class EnemyGrid;
+
+// The living enemies inside one tower's range, kept as a heap on the score
+// of a single targeting policy: distance, arrival time, share of health left
+// or bosses before distance. Building it visits only the shared EnemyGrid
+// cells under the range and heapifies the k enemies found in O(k); the best
+// target is then the top of the heap. Only the tower's active policy is
+// built, since a tower never asks for more than one per query.
+class TargetIndex
+{
+public:
+    struct Candidate
+    {
+        EnemyHandle handle;
+        Vector2f position;
+        float distance;
+        // health / maxHealth
+        float healthFraction;
+        float arrivalTime;
+        bool isBoss;
+        // Score under the policy the index was built for
+        float score;
+    };
+
+    TargetIndex();
+
+    // current is looked up on the way, so keeping it costs no extra search
+    void Build(const EnemyWorld& enemies, const EnemyGrid& grid, const Vector2f& center, float range,
+        TargetingPolicy policy, EnemyHandle current);
+
+    // Null when nothing is in range
+    const Candidate* Select() const;
+    // The current target passed to Build, null when it is not in range
+    const Candidate* GetCurrent() const;
+    // Lower is better, comparable between candidates of one policy
+    static float Score(TargetingPolicy policy, const Candidate& candidate);
+    // Hysteresis: true when candidate beats current by more than margin.
+    // Distance and arrival time compare relatively, within the same boss
+    // class for BossFirst; health policies use an absolute margin on the
+    // health fraction.
+    static bool IsClearlyBetter(TargetingPolicy policy, const Candidate& candidate, const Candidate& current,
+        float margin);
+
+private:
+    std::vector<Candidate> m_Heap;
+    // A copy, since heapifying moves the candidates around
+    Candidate m_Current;
+    bool m_HasCurrent;
+};
@@ -0,0 +1,21 @@
+#include "pch.h"
+#include "TargetingPolicy.h"
+
+const char* GetTargetingPolicyName(TargetingPolicy policy)
+{
+    switch (policy)
+    {
+    case TargetingPolicy::Nearest: return "Nearest";
+    case TargetingPolicy::First: return "First";
+    case TargetingPolicy::Strongest: return "Strongest";
+    case TargetingPolicy::Weakest: return "Weakest";
+    case TargetingPolicy::BossFirst: return "Boss First";
+    default: return "Unknown";
+    }
+}
+
+TargetingPolicy GetNextTargetingPolicy(TargetingPolicy policy)
+{
+    int next = (static_cast<int>(policy) + 1) % static_cast<int>(TargetingPolicy::Count);
+    return static_cast<TargetingPolicy>(next);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// How a tower picks its target among the enemies in range
+enum class TargetingPolicy
+{
+    Nearest,    // closest to the tower
+    First,      // reaches the tower soonest (distance / speed)
+    Strongest,  // largest share of its health left
+    Weakest,    // smallest share of its health left
+    BossFirst,  // nearest boss, otherwise nearest enemy
+    Count
+};
+
+const char* GetTargetingPolicyName(TargetingPolicy policy);
+TargetingPolicy GetNextTargetingPolicy(TargetingPolicy policy);
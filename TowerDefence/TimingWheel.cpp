@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "TimingWheel.h"
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+TimingWheel::TimingWheel()
+    : m_Tick{ 0 }
+    , m_PendingCount{ 0 }
+{
+}
+
+void TimingWheel::Schedule(uint32_t tick, TimerKind kind, uint32_t target)
+{
+    Insert(Timer{ std::max(tick, m_Tick + 1), kind, target });
+    ++m_PendingCount;
+}
+
+const std::vector<Timer>& TimingWheel::Advance()
+{
+    m_Due.clear();
+    ++m_Tick;
+
+    // Higher levels first, so their timers can fall all the way to level 0
+    if ((m_Tick & ((1u << (SlotBits * LevelCount)) - 1)) == 0)
+        Cascade(m_Overflow);
+    for (int level = LevelCount - 1; level >= 1; --level)
+    {
+        uint32_t shift = SlotBits * level;
+        if ((m_Tick & ((1u << shift) - 1)) == 0)
+            Cascade(m_Slots[level][(m_Tick >> shift) & (SlotCount - 1)]);
+    }
+
+    m_Due.swap(m_Slots[0][m_Tick & (SlotCount - 1)]);
+    m_PendingCount -= m_Due.size();
+    std::sort(m_Due.begin(), m_Due.end(), [](const Timer& a, const Timer& b) {
+        if (a.kind != b.kind) return a.kind < b.kind;
+        return a.target < b.target;
+    });
+    return m_Due;
+}
+
+void TimingWheel::Clear()
+{
+    for (int level = 0; level < LevelCount; ++level)
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+            m_Slots[level][slot].clear();
+    m_Overflow.clear();
+    m_PendingCount = 0;
+}
+
+uint32_t TimingWheel::ToTicks(float seconds, float tickSeconds)
+{
+    // The small bias keeps float noise from adding a tick to exact multiples
+    float ticks = std::ceil(seconds / tickSeconds - 0.001f);
+    if (ticks < 1.f) return 1;
+    // Effectively never, but still far from wrapping the clock
+    if (ticks > 1e9f) return 1000000000u;
+    return static_cast<uint32_t>(ticks);
+}
+
+void TimingWheel::Insert(const Timer& timer)
+{
+    // The lowest level whose slots still separate the timer from the clock
+    for (int level = 0; level < LevelCount; ++level)
+    {
+        uint32_t shift = SlotBits * (level + 1);
+        if ((timer.tick >> shift) == (m_Tick >> shift))
+        {
+            m_Slots[level][(timer.tick >> (SlotBits * level)) & (SlotCount - 1)].push_back(timer);
+            return;
+        }
+    }
+    m_Overflow.push_back(timer);
+}
+
+void TimingWheel::Cascade(std::vector<Timer>& slot)
+{
+    m_Scratch.swap(slot);
+    for (const Timer& timer : m_Scratch)
+        Insert(timer);
+    m_Scratch.clear();
+}
+
+void TimingWheel::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteU32(m_Tick);
+    writer.WriteU32(static_cast<uint32_t>(m_PendingCount));
+    auto writeTimers = [&writer](const std::vector<Timer>& timers) {
+        for (const Timer& timer : timers)
+        {
+            writer.WriteU32(timer.tick);
+            writer.WriteU32(static_cast<uint32_t>(timer.kind));
+            writer.WriteU32(timer.target);
+        }
+    };
+    for (int level = 0; level < LevelCount; ++level)
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+            writeTimers(m_Slots[level][slot]);
+    writeTimers(m_Overflow);
+}
+
+void TimingWheel::ReadState(SnapshotReader& reader)
+{
+    Clear();
+    m_Tick = reader.ReadU32();
+    uint32_t count = reader.ReadU32();
+    for (uint32_t i = 0; i < count && reader.IsOk(); ++i)
+    {
+        Timer timer{};
+        timer.tick = reader.ReadU32();
+        timer.kind = static_cast<TimerKind>(reader.ReadU32());
+        timer.target = reader.ReadU32();
+        Insert(timer);
+        ++m_PendingCount;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class SnapshotWriter;
+class SnapshotReader;
+
+// What a timer does when it fires. Enemy timers carry an EnemyHandle value as
+// their target, so timers of enemies that died in the meantime are ignored;
+// script timers carry the script's frame index.
+enum class TimerKind : uint32_t
+{
+    Script,
+    NotificationExpiry,
+    MeleeReady,
+    RangedReady
+};
+
+struct Timer
+{
+    uint32_t tick;
+    TimerKind kind;
+    uint32_t target;
+};
+
+// Hierarchical timing wheel over simulation ticks. Four levels of 64 slots
+// cover 2^24 ticks (about three days at 60 Hz); timers further out wait in an
+// overflow list. A tick only touches the slot that is due, plus one slot of a
+// higher level every 64, 4096 or 262144 ticks when its timers move down a
+// level, so pending timers cost nothing until they fire.
+class TimingWheel
+{
+public:
+    TimingWheel();
+
+    // Timers at or before the current tick fire on the next Advance
+    void Schedule(uint32_t tick, TimerKind kind, uint32_t target);
+    void ScheduleIn(uint32_t ticks, TimerKind kind, uint32_t target) { Schedule(m_Tick + ticks, kind, target); }
+    // Moves to the next tick and returns its timers, sorted by kind and target
+    // so the order does not depend on when they were scheduled. The list stays
+    // valid until the next Advance.
+    const std::vector<Timer>& Advance();
+    // Drops every pending timer; the clock keeps running
+    void Clear();
+
+    uint32_t GetTick() const { return m_Tick; }
+    size_t GetPendingCount() const { return m_PendingCount; }
+
+    // Whole ticks needed for a duration, never less than one
+    static uint32_t ToTicks(float seconds, float tickSeconds);
+
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
+
+private:
+    static const int LevelCount{ 4 };
+    static const uint32_t SlotBits{ 6 };
+    static const uint32_t SlotCount{ 1u << SlotBits };
+
+    void Insert(const Timer& timer);
+    // Moves every timer of one slot down to the levels below
+    void Cascade(std::vector<Timer>& slot);
+
+    uint32_t m_Tick;
+    size_t m_PendingCount;
+    std::vector<Timer> m_Slots[LevelCount][SlotCount];
+    std::vector<Timer> m_Overflow;
+    std::vector<Timer> m_Due;
+    std::vector<Timer> m_Scratch;
+};
@@ -1,11 +1,25 @@
 #include "pch.h"
 #include "Tower.h"
 #include "Bullet.h"
+#include "CircleRenderer.h"
 #include "utils.h"
-#include "EnemyBase.h" 
+#include "EnemyWorld.h"
+#include "Snapshot.h"
+#include "TimingWheel.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+
+namespace
+{
+    const float g_BulletSpeed{ 200.f };
+    // Longest flight that is resolved at fire time, and how much faster than
+    // its target a shot has to be, so the target barely moves in between
+    const float g_MaxAnalyticFlight{ 0.5f };
+    const float g_MinAnalyticSpeedRatio{ 4.f };
+    const float g_TracerLength{ 12.f };
+}
 
 Tower::Tower(Rectf tower, float range, float damage)
     : m_Tower(tower)
@@ -16,10 +30,27 @@ Tower::Tower(Rectf tower, float range, float damage)
     , m_MaxHealth(100)
     , m_Health(100)
     , m_RicochetCount(0)
+    , m_SplashRadius(0.0f)
+    , m_ExplosiveDamage(0.0f)
+    , m_ChainJumps(0)
+    , m_SlowAmount(0.0f)
+    , m_BurnDamage(0.0f)
+    , m_PoisonDamage(0.0f)
+    , m_StunChance(0.0f)
+    , m_AnalyticHits(false)
+    , m_Target{}
+    , m_RetargetTimer(0.0f)
+    , m_RetargetInterval(0.5f)
+    , m_SwitchMargin(0.2f)
+    , m_TargetQueries(0)
+    , m_CachedShots(0)
+    , m_Policy(TargetingPolicy::Nearest)
+    , m_PolicyQueries{}
+    , m_PolicyMicroseconds{}
 {
 }
 
-void Tower::Update(float elapsedSec, const std::vector<EnemyBase*>& enemies, float windowWidth, float windowHeight)
+void Tower::Update(float elapsedSec, const EnemyWorld& enemies, const EnemyGrid& grid, float windowWidth, float windowHeight)
 {
     if (m_AttackTimer > 0.0f)
     {
@@ -28,6 +59,16 @@ void Tower::Update(float elapsedSec, const std::vector<EnemyBase*>& enemies, flo
 
     for (auto bulletIt = m_Bullets.begin(); bulletIt != m_Bullets.end();)
     {
+        // Ricocheted bullets follow their target until it is gone
+        EnemyHandle target = bulletIt->GetHomingTarget();
+        if (!target.IsNull())
+        {
+            const TransformComponent* pTarget = enemies.FindTransform(target);
+            if (pTarget)
+                bulletIt->SetTarget(pTarget->shape.center.x, pTarget->shape.center.y);
+            else
+                bulletIt->SetHomingTarget(EnemyHandle{});
+        }
         bulletIt->Update(elapsedSec, windowWidth, windowHeight);
         if (!bulletIt->IsActive())
         {
@@ -39,64 +80,166 @@ void Tower::Update(float elapsedSec, const std::vector<EnemyBase*>& enemies, flo
         }
     }
 
-    if (m_AttackTimer <= 0.0f && !enemies.empty())
+    if (m_RetargetTimer > 0.0f)
     {
-        float towerCenterX = m_Tower.left + m_Tower.width / 2.0f;
-        float towerCenterY = m_Tower.bottom + m_Tower.height / 2.0f;
+        m_RetargetTimer -= elapsedSec;
+    }
 
-        EnemyBase* nearestEnemy = nullptr;
-        float nearestDistance = m_Range + 1.0f;
-        for (EnemyBase* enemy : enemies)
+    if (m_AttackTimer <= 0.0f && !enemies.IsEmpty())
+    {
+        const Vector2f* pTarget = SelectTarget(enemies, grid);
+        if (pTarget)
         {
-            float enemyCenterX = enemy->GetShape().center.x;
-            float enemyCenterY = enemy->GetShape().center.y;
-
-            float dx = enemyCenterX - towerCenterX;
-            float dy = enemyCenterY - towerCenterY;
-            float distance = std::sqrt(dx * dx + dy * dy);
+            Vector2f towerCenter = GetCenter();
+            int bulletHP = 1 + m_RicochetCount;
 
-            if (distance <= m_Range && distance < nearestDistance)
+            if (!FireAnalytic(enemies, towerCenter, *pTarget, elapsedSec))
             {
-                nearestDistance = distance;
-                nearestEnemy = enemy;
+                m_Bullets.emplace_back(
+                    towerCenter.x, towerCenter.y,
+                    pTarget->x, pTarget->y,
+                    g_BulletSpeed,
+                    m_Damage,
+                    bulletHP
+                );
             }
+
+            m_AttackTimer = 1.0f / m_AttackSpeed; 
         }
+    }
+}
 
-        if (nearestEnemy)
-        {
-            float enemyCenterX = nearestEnemy->GetShape().center.x;
-            float enemyCenterY = nearestEnemy->GetShape().center.y;
-            int bulletHP = 1 + m_RicochetCount;
+bool Tower::FireAnalytic(const EnemyWorld& enemies, const Vector2f& from, const Vector2f& to, float elapsedSec)
+{
+    if (!m_AnalyticHits || m_RicochetCount > 0) return false;
+    EnemyType type;
+    size_t row;
+    if (!enemies.Locate(m_Target, type, row)) return false;
+    const EnemyArchetype& archetype = enemies.GetArchetype(type);
+    if (g_BulletSpeed < archetype.movements[row].speed * g_MinAnalyticSpeedRatio) return false;
+
+    // A bullet hits as soon as it touches the target's ellipse
+    float dx = to.x - from.x;
+    float dy = to.y - from.y;
+    float distance = std::max(0.f, std::sqrt(dx * dx + dy * dy) - archetype.transforms[row].shape.radiusX);
+    float flight = distance / g_BulletSpeed;
+    if (flight > g_MaxAnalyticFlight) return false;
+    // Once the queued hits already kill the target, the shot flies for real
+    // so it can still hit whatever is behind
+    float queuedDamage = 0.f;
+    for (const TowerHit& hit : m_PendingHits)
+    {
+        if (hit.target == m_Target) queuedDamage += hit.damage;
+    }
+    if (queuedDamage >= archetype.healths[row].health) return false;
 
-            m_Bullets.emplace_back(
-                towerCenterX, towerCenterY,
-                enemyCenterX, enemyCenterY,
-                200.0f, 
-                m_Damage,
-                bulletHP
-            );
+    int ticks = static_cast<int>(TimingWheel::ToTicks(flight, elapsedSec));
+    m_PendingHits.push_back(TowerHit{ m_Target, m_Damage, ticks, ticks, from, to });
+    return true;
+}
 
-            m_AttackTimer = 1.0f / m_AttackSpeed; 
-        }
+Vector2f Tower::GetCenter() const
+{
+    return Vector2f{ m_Tower.left + m_Tower.width / 2.0f, m_Tower.bottom + m_Tower.height / 2.0f };
+}
+
+Ellipsef Tower::GetShape() const
+{
+    return Ellipsef{ GetCenter(), m_Tower.width / 2.0f, m_Tower.height / 2.0f };
+}
+
+const Vector2f* Tower::FindInRange(const EnemyWorld& enemies, EnemyHandle handle) const
+{
+    EnemyType type;
+    size_t row;
+    if (!enemies.Locate(handle, type, row)) return nullptr;
+    const EnemyArchetype& archetype = enemies.GetArchetype(type);
+    // Killed this tick but not removed yet
+    if (archetype.healths[row].health <= 0.f) return nullptr;
+    const Vector2f& center = archetype.transforms[row].shape.center;
+    Vector2f towerCenter = GetCenter();
+    float dx = center.x - towerCenter.x;
+    float dy = center.y - towerCenter.y;
+    return dx * dx + dy * dy <= m_Range * m_Range ? &center : nullptr;
+}
+
+const Vector2f* Tower::SelectTarget(const EnemyWorld& enemies, const EnemyGrid& grid)
+{
+    const Vector2f* pCurrent = FindInRange(enemies, m_Target);
+    if (pCurrent && m_RetargetTimer > 0.0f)
+    {
+        ++m_CachedShots;
+        return pCurrent;
+    }
+
+    ++m_TargetQueries;
+    m_RetargetTimer = m_RetargetInterval;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    m_TargetIndex.Build(enemies, grid, GetCenter(), m_Range, m_Policy, pCurrent ? m_Target : EnemyHandle{});
+    const TargetIndex::Candidate* pCandidate = m_TargetIndex.Select();
+    const TargetIndex::Candidate* pKept = m_TargetIndex.GetCurrent();
+    EnemyHandle candidate = pCandidate ? pCandidate->handle : EnemyHandle{};
+    if (pCandidate && pKept && candidate != m_Target)
+    {
+        // Hysteresis: only drop a valid target for a clearly better one
+        if (!TargetIndex::IsClearlyBetter(m_Policy, *pCandidate, *pKept, m_SwitchMargin))
+            candidate = m_Target;
     }
+    m_Target = candidate;
+
+    int policy = static_cast<int>(m_Policy);
+    ++m_PolicyQueries[policy];
+    m_PolicyMicroseconds[policy] += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return FindInRange(enemies, m_Target);
+}
+
+void Tower::SetTargeting(float retargetInterval, float switchMargin)
+{
+    m_RetargetInterval = retargetInterval;
+    m_SwitchMargin = switchMargin;
+}
+
+void Tower::SetTargetingPolicy(TargetingPolicy policy)
+{
+    m_Policy = policy;
+    // Re-evaluate on the next shot instead of finishing off the old pick
+    m_RetargetTimer = 0.0f;
+}
+
+void Tower::CycleTargetingPolicy()
+{
+    SetTargetingPolicy(GetNextTargetingPolicy(m_Policy));
+}
+
+float Tower::GetAverageQueryMicroseconds(TargetingPolicy policy) const
+{
+    int index = static_cast<int>(policy);
+    return m_PolicyQueries[index] > 0 ? float(m_PolicyMicroseconds[index] / m_PolicyQueries[index]) : 0.f;
 }
 
-void Tower::Draw() const
+void Tower::Draw(CircleRenderer& circles) const
 {
     utils::SetColor(Color4f(0.2f, 0.2f, 0.8f, 1.0f));
     utils::FillRect(m_Tower);
 
-    utils::SetColor(Color4f(0.5f, 0.5f, 0.9f, 0.3f));
-    float centerX = m_Tower.left + m_Tower.width / 2.0f;
-    float centerY = m_Tower.bottom + m_Tower.height / 2.0f;
-    utils::FillEllipse(centerX, centerY, m_Range, m_Range);
-
-    utils::SetColor(Color4f(0.3f, 0.3f, 1.0f, 0.7f));
-    utils::DrawEllipse(centerX, centerY, m_Range, m_Range, 2.0f);
+    const Vector2f center{ m_Tower.left + m_Tower.width / 2.0f, m_Tower.bottom + m_Tower.height / 2.0f };
+    circles.Fill(center, m_Range, m_Range, Color4f(0.5f, 0.5f, 0.9f, 0.3f));
+    circles.Outline(center, m_Range, m_Range, Color4f(0.3f, 0.3f, 1.0f, 0.7f), 2.0f);
+}
 
-    for (const Bullet& bullet : m_Bullets)
+void Tower::DrawTracers() const
+{
+    utils::SetColor(Color4f(1.f, 1.f, 0.6f, 0.9f));
+    for (const TowerHit& hit : m_PendingHits)
     {
-        bullet.Draw();
+        float dx = hit.to.x - hit.from.x;
+        float dy = hit.to.y - hit.from.y;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length <= 0.f) continue;
+        float t = 1.f - float(hit.ticksLeft) / hit.flightTicks;
+        float tail = std::max(0.f, t - g_TracerLength / length);
+        utils::DrawLine(hit.from.x + dx * tail, hit.from.y + dy * tail, hit.from.x + dx * t, hit.from.y + dy * t, 2.f);
     }
 }
 
@@ -125,6 +268,11 @@ std::vector<Bullet>& Tower::GetBullets()
     return m_Bullets;
 }
 
+size_t Tower::GetBulletCount() const
+{
+    return m_Bullets.size();
+}
+
 void Tower::UpgradeDamage(float amount)
 {
     m_Damage += amount;
@@ -160,6 +308,41 @@ void Tower::UpgradeRicochet(int amount)
     m_RicochetCount += amount;
 }
 
+void Tower::UpgradeSplash(float radius)
+{
+    m_SplashRadius += radius;
+}
+
+void Tower::UpgradeExplosive(float damage)
+{
+    m_ExplosiveDamage += damage;
+}
+
+void Tower::UpgradeChainLightning(int jumps)
+{
+    m_ChainJumps += jumps;
+}
+
+void Tower::UpgradeSlow(float amount)
+{
+    m_SlowAmount += amount;
+}
+
+void Tower::UpgradeBurn(float damagePerSecond)
+{
+    m_BurnDamage += damagePerSecond;
+}
+
+void Tower::UpgradePoison(float damagePerSecond)
+{
+    m_PoisonDamage += damagePerSecond;
+}
+
+void Tower::UpgradeStun(float chance)
+{
+    m_StunChance += chance;
+}
+
 void Tower::IncreaseRicochet(int amount)
 {
     UpgradeRicochet(static_cast<int>(amount));
@@ -184,14 +367,115 @@ void Tower::ResetToInitialStats()
     m_MaxHealth = 100;
     m_Health = 100;
     m_RicochetCount = 0;
-    
+    m_SplashRadius = 0.f;
+    m_ExplosiveDamage = 0.f;
+    m_ChainJumps = 0;
+    m_SlowAmount = 0.f;
+    m_BurnDamage = 0.f;
+    m_PoisonDamage = 0.f;
+    m_StunChance = 0.f;
+    m_AttackTimer = 0.f;
+    m_Target = EnemyHandle{};
+    m_RetargetTimer = 0.f;
+    m_Policy = TargetingPolicy::Nearest;
+}
+
+void Tower::CopyUpgradesFrom(const Tower& other)
+{
+    m_Range = other.m_Range;
+    m_Damage = other.m_Damage;
+    m_AttackSpeed = other.m_AttackSpeed;
+    m_RicochetCount = other.m_RicochetCount;
+    m_SplashRadius = other.m_SplashRadius;
+    m_ExplosiveDamage = other.m_ExplosiveDamage;
+    m_ChainJumps = other.m_ChainJumps;
+    m_SlowAmount = other.m_SlowAmount;
+    m_BurnDamage = other.m_BurnDamage;
+    m_PoisonDamage = other.m_PoisonDamage;
+    m_StunChance = other.m_StunChance;
+    m_Policy = other.m_Policy;
+    m_AnalyticHits = other.m_AnalyticHits;
 }
 
 void Tower::ClearBullets()
 {
     m_Bullets.clear();
+    m_PendingHits.clear();
 }
 
 void Tower::SetPosition(const Rectf& rect) {
     m_Tower = rect;
-}
\ No newline at end of file
+}
+
+void Tower::WriteState(SnapshotWriter& writer) const
+{
+    writer.WriteRect(m_Tower);
+    writer.WriteFloat(m_Range);
+    writer.WriteFloat(m_Damage);
+    writer.WriteFloat(m_AttackSpeed);
+    writer.WriteFloat(m_AttackTimer);
+    writer.WriteInt(m_MaxHealth);
+    writer.WriteInt(m_Health);
+    writer.WriteInt(m_RicochetCount);
+    writer.WriteFloat(m_SplashRadius);
+    writer.WriteFloat(m_ExplosiveDamage);
+    writer.WriteInt(m_ChainJumps);
+    writer.WriteFloat(m_SlowAmount);
+    writer.WriteFloat(m_BurnDamage);
+    writer.WriteFloat(m_PoisonDamage);
+    writer.WriteFloat(m_StunChance);
+    writer.WriteU32(m_Target.value);
+    writer.WriteFloat(m_RetargetTimer);
+    writer.WriteInt(static_cast<int>(m_Policy));
+    Bullet::WriteBullets(writer, m_Bullets);
+    writer.WriteBool(m_AnalyticHits);
+    writer.WriteU32(static_cast<uint32_t>(m_PendingHits.size()));
+    for (const TowerHit& hit : m_PendingHits)
+    {
+        writer.WriteU32(hit.target.value);
+        writer.WriteFloat(hit.damage);
+        writer.WriteInt(hit.ticksLeft);
+        writer.WriteInt(hit.flightTicks);
+        writer.WriteVector(hit.from);
+        writer.WriteVector(hit.to);
+    }
+}
+
+void Tower::ReadState(SnapshotReader& reader)
+{
+    m_Tower = reader.ReadRect();
+    m_Range = reader.ReadFloat();
+    m_Damage = reader.ReadFloat();
+    m_AttackSpeed = reader.ReadFloat();
+    m_AttackTimer = reader.ReadFloat();
+    m_MaxHealth = reader.ReadInt();
+    m_Health = reader.ReadInt();
+    m_RicochetCount = reader.ReadInt();
+    m_SplashRadius = reader.ReadFloat();
+    m_ExplosiveDamage = reader.ReadFloat();
+    m_ChainJumps = reader.ReadInt();
+    m_SlowAmount = reader.ReadFloat();
+    m_BurnDamage = reader.ReadFloat();
+    m_PoisonDamage = reader.ReadFloat();
+    m_StunChance = reader.ReadFloat();
+    m_Target.value = reader.ReadU32();
+    m_RetargetTimer = reader.ReadFloat();
+    int policy = reader.ReadInt();
+    m_Policy = policy >= 0 && policy < static_cast<int>(TargetingPolicy::Count)
+        ? static_cast<TargetingPolicy>(policy) : TargetingPolicy::Nearest;
+    Bullet::ReadBullets(reader, m_Bullets);
+    m_AnalyticHits = reader.ReadBool();
+    m_PendingHits.clear();
+    uint32_t hitCount = reader.ReadU32();
+    for (uint32_t i = 0; i < hitCount && reader.IsOk(); ++i)
+    {
+        TowerHit hit{};
+        hit.target.value = reader.ReadU32();
+        hit.damage = reader.ReadFloat();
+        hit.ticksLeft = reader.ReadInt();
+        hit.flightTicks = reader.ReadInt();
+        hit.from = reader.ReadVector();
+        hit.to = reader.ReadVector();
+        m_PendingHits.push_back(hit);
+    }
+}
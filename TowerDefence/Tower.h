@@ -1,26 +1,60 @@
 #pragma once
 #include "structs.h" 
+#include "EnemyHandle.h"
+#include "TargetIndex.h"
 #include <vector>
 #include <algorithm>
 
-class EnemyBase;
+class EnemyWorld;
+class EnemyGrid;
 class Bullet;
+class CircleRenderer;
+class SnapshotWriter;
+class SnapshotReader;
+
+// A shot resolved when it was fired: the damage lands on the target once the
+// flight time has passed, and until then only a tracer is drawn
+struct TowerHit
+{
+    EnemyHandle target;
+    float damage;
+    int ticksLeft;
+    int flightTicks;
+    Vector2f from;
+    Vector2f to;
+};
 
 class Tower
 {
 public:
     Tower(Rectf tower, float range, float damage = 1.f);
-    void Draw() const;
-    void Update(float elapsedSec, const std::vector<EnemyBase*>& enemies, float windowWidth, float windowHeight);
+    // Draws the body and queues the range ring; Game flushes the rings of all
+    // towers in one go before their tracers are drawn
+    void Draw(CircleRenderer& circles) const;
+    void DrawTracers() const;
+    // Only touches this tower's own state, so towers can update in parallel
+    void Update(float elapsedSec, const EnemyWorld& enemies, const EnemyGrid& grid, float windowWidth, float windowHeight);
     const Rectf& GetPosition() const;
+    Vector2f GetCenter() const;
+    // The ellipse enemies and their shots collide with
+    Ellipsef GetShape() const;
 
     void ResetToInitialStats();
+    // Placed towers start with everything the main tower was upgraded with
+    void CopyUpgradesFrom(const Tower& other);
     void ClearBullets();
     void UpgradeDamage(float amount);
     void UpgradeRange(float amount);
     void UpgradeAttackSpeed(float amount);
     void UpgradeMaxHealth(float amt);
     void UpgradeRicochet(int amount);
+    void UpgradeSplash(float radius);
+    void UpgradeExplosive(float damage);
+    void UpgradeChainLightning(int jumps);
+    void UpgradeSlow(float amount);
+    void UpgradeBurn(float damagePerSecond);
+    void UpgradePoison(float damagePerSecond);
+    void UpgradeStun(float chance);
 
     void IncreaseDamage(float amount);
     void IncreaseRange(float amount);
@@ -31,16 +65,58 @@ public:
     float GetRange() const;
     float GetAttackSpeed() const;
     std::vector<Bullet>& GetBullets();
+    std::vector<TowerHit>& GetPendingHits() { return m_PendingHits; }
+    size_t GetBulletCount() const;
+    size_t GetPendingHitCount() const { return m_PendingHits.size(); }
     Rectf GetRect() const { return m_Tower; }
     int GetMaxHealth() const { return m_MaxHealth; }
     int GetHealth() const { return m_Health; }
     int GetRicochetCount() const;
+    // Area upgrades, applied by the TowerBulletHits system wherever a shot lands
+    float GetSplashRadius() const { return m_SplashRadius; }
+    float GetExplosiveDamage() const { return m_ExplosiveDamage; }
+    int GetChainJumps() const { return m_ChainJumps; }
+    // Status effects put on every enemy a shot hits directly
+    float GetSlowAmount() const { return m_SlowAmount; }
+    float GetBurnDamage() const { return m_BurnDamage; }
+    float GetPoisonDamage() const { return m_PoisonDamage; }
+    float GetStunChance() const { return m_StunChance; }
 
     void Heal(int amount) {
         m_Health = std::min(m_Health + amount, m_MaxHealth);
     }
+    void TakeDamage(int amount) { m_Health -= amount; }
+    bool IsDestroyed() const { return m_Health <= 0; }
+
+    // Targeting: the current target is kept while it lives and stays in range.
+    // A full query under the targeting policy runs when it is lost or every
+    // retargetInterval seconds, and a new target only wins if it is better by
+    // switchMargin: Nearest, First and BossFirst need a distance or arrival
+    // time that much shorter (a fraction, BossFirst only within the same
+    // boss class), Strongest and Weakest a health fraction that many points
+    // apart. A margin above 0 means the pick can differ from a plain query.
+    void SetTargeting(float retargetInterval, float switchMargin);
+    EnemyHandle GetTarget() const { return m_Target; }
+    // Includes the queries that find nothing in range; a ready tower repeats
+    // those every tick, so they outnumber the shots while the field is empty.
+    uint32_t GetTargetQueryCount() const { return m_TargetQueries; }
+    uint32_t GetCachedShotCount() const { return m_CachedShots; }
+
+    // Off by default. When on, shots that reach a much slower target within
+    // half a second skip the simulated bullet and become a TowerHit.
+    // Ricochet shots always fly, since they need to collide.
+    void SetAnalyticHits(bool enabled) { m_AnalyticHits = enabled; }
+    bool GetAnalyticHits() const { return m_AnalyticHits; }
+
+    void SetTargetingPolicy(TargetingPolicy policy);
+    void CycleTargetingPolicy();
+    TargetingPolicy GetTargetingPolicy() const { return m_Policy; }
+    // Average cost of one full query (index build + selection) under a policy
+    float GetAverageQueryMicroseconds(TargetingPolicy policy) const;
 
     void SetPosition(const Rectf& rect);
+    void WriteState(SnapshotWriter& writer) const;
+    void ReadState(SnapshotReader& reader);
 
 private:
     float m_Range;
@@ -49,7 +125,33 @@ private:
     float m_AttackTimer;
     Rectf m_Tower;
     std::vector<Bullet> m_Bullets;
+    std::vector<TowerHit> m_PendingHits;
     int m_MaxHealth{ 100 };
     int m_Health{ 100 };
     int m_RicochetCount = 0;
+    float m_SplashRadius;
+    float m_ExplosiveDamage;
+    int m_ChainJumps;
+    float m_SlowAmount;
+    float m_BurnDamage;
+    float m_PoisonDamage;
+    float m_StunChance;
+    bool m_AnalyticHits;
+
+    EnemyHandle m_Target;
+    float m_RetargetTimer;
+    float m_RetargetInterval;
+    float m_SwitchMargin;
+    uint32_t m_TargetQueries;
+    uint32_t m_CachedShots;
+    TargetingPolicy m_Policy;
+    TargetIndex m_TargetIndex;
+    uint32_t m_PolicyQueries[static_cast<int>(TargetingPolicy::Count)];
+    double m_PolicyMicroseconds[static_cast<int>(TargetingPolicy::Count)];
+
+    const Vector2f* FindInRange(const EnemyWorld& enemies, EnemyHandle handle) const;
+    const Vector2f* SelectTarget(const EnemyWorld& enemies, const EnemyGrid& grid);
+    // Queues a TowerHit on the current target instead of a bullet, false when
+    // the shot has to be simulated
+    bool FireAnalytic(const EnemyWorld& enemies, const Vector2f& from, const Vector2f& to, float elapsedSec);
 };
\ No newline at end of file
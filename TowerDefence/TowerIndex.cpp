@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "TowerIndex.h"
+#include "Tower.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const size_t g_ScanLimit{ 8 };
+}
+
+TowerIndex::TowerIndex(float cellSize)
+    : m_CellSize{ cellSize }
+    , m_Columns{ 1 }
+    , m_Rows{ 1 }
+{
+}
+
+void TowerIndex::Build(const std::vector<Tower*>& towers, float width, float height)
+{
+    m_Columns = std::max(1, static_cast<int>(std::ceil(width / m_CellSize)));
+    m_Rows = std::max(1, static_cast<int>(std::ceil(height / m_CellSize)));
+    size_t cellCount = static_cast<size_t>(m_Columns) * m_Rows;
+    m_CellStart.assign(cellCount + 1, 0);
+    m_Entries.resize(towers.size());
+
+    std::vector<uint32_t> cells(towers.size());
+    for (size_t i = 0; i < towers.size(); ++i)
+    {
+        Vector2f center = towers[i]->GetCenter();
+        cells[i] = static_cast<uint32_t>(GetRow(center.y) * m_Columns + GetColumn(center.x));
+        ++m_CellStart[cells[i] + 1];
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell)
+        m_CellStart[cell + 1] += m_CellStart[cell];
+
+    std::vector<uint32_t> fill(m_CellStart.begin(), m_CellStart.end() - 1);
+    for (size_t i = 0; i < towers.size(); ++i)
+        m_Entries[fill[cells[i]]++] = Entry{ towers[i]->GetCenter(), static_cast<int>(i) };
+}
+
+int TowerIndex::FindNearest(const Vector2f& position) const
+{
+    if (m_Entries.empty()) return -1;
+    // With only a handful of towers a plain scan beats walking empty cells
+    if (m_Entries.size() <= g_ScanLimit) return FindNearestByScan(position);
+
+    int startX = GetColumn(position.x);
+    int startY = GetRow(position.y);
+    int maxRing = std::max(m_Columns, m_Rows);
+    int nearest = -1;
+    float nearestDistanceSq = std::numeric_limits<float>::max();
+
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        for (int y = startY - ring; y <= startY + ring; ++y)
+        {
+            if (y < 0 || y >= m_Rows) continue;
+            // Interior rows of the ring only have their two edge cells
+            int step = (y == startY - ring || y == startY + ring) ? 1 : std::max(1, 2 * ring);
+            for (int x = startX - ring; x <= startX + ring; x += step)
+            {
+                if (x < 0 || x >= m_Columns) continue;
+                int cell = y * m_Columns + x;
+                for (uint32_t i = m_CellStart[cell]; i < m_CellStart[cell + 1]; ++i)
+                {
+                    const Entry& entry = m_Entries[i];
+                    float dx = entry.center.x - position.x;
+                    float dy = entry.center.y - position.y;
+                    float distanceSq = dx * dx + dy * dy;
+                    if (distanceSq < nearestDistanceSq || (distanceSq == nearestDistanceSq && entry.tower < nearest))
+                    {
+                        nearestDistanceSq = distanceSq;
+                        nearest = entry.tower;
+                    }
+                }
+            }
+        }
+        // Anything not searched yet lies outside the block of cells covered so
+        // far; sides already at the grid border have nothing left beyond them
+        float bound = std::numeric_limits<float>::max();
+        if (startX - ring > 0) bound = std::min(bound, position.x - (startX - ring) * m_CellSize);
+        if (startX + ring < m_Columns - 1) bound = std::min(bound, (startX + ring + 1) * m_CellSize - position.x);
+        if (startY - ring > 0) bound = std::min(bound, position.y - (startY - ring) * m_CellSize);
+        if (startY + ring < m_Rows - 1) bound = std::min(bound, (startY + ring + 1) * m_CellSize - position.y);
+        if (bound == std::numeric_limits<float>::max()) break;
+        if (nearest >= 0 && nearestDistanceSq <= bound * bound) break;
+    }
+    return nearest;
+}
+
+int TowerIndex::FindNearestByScan(const Vector2f& position) const
+{
+    int nearest = -1;
+    float nearestDistanceSq = std::numeric_limits<float>::max();
+    for (const Entry& entry : m_Entries)
+    {
+        float dx = entry.center.x - position.x;
+        float dy = entry.center.y - position.y;
+        float distanceSq = dx * dx + dy * dy;
+        if (distanceSq < nearestDistanceSq || (distanceSq == nearestDistanceSq && entry.tower < nearest))
+        {
+            nearestDistanceSq = distanceSq;
+            nearest = entry.tower;
+        }
+    }
+    return nearest;
+}
+
+int TowerIndex::GetColumn(float x) const
+{
+    int column = static_cast<int>(std::floor(x / m_CellSize));
+    return std::min(std::max(column, 0), m_Columns - 1);
+}
+
+int TowerIndex::GetRow(float y) const
+{
+    int row = static_cast<int>(std::floor(y / m_CellSize));
+    return std::min(std::max(row, 0), m_Rows - 1);
+}
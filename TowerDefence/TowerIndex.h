@@ -0,0 +1,38 @@
+#pragma once
+#include "structs.h"
+#include <vector>
+#include <cstdint>
+
+class Tower;
+
+// Uniform grid over the tower centres, so an enemy finds its nearest tower by
+// searching outward ring by ring instead of testing every tower. Towers only
+// move when one is placed or destroyed, so the index is rebuilt on demand.
+class TowerIndex
+{
+public:
+    explicit TowerIndex(float cellSize = 128.f);
+
+    void Build(const std::vector<Tower*>& towers, float width, float height);
+
+    // Index into the tower list the index was built from, -1 when it is empty.
+    // Equal distances resolve to the lowest index.
+    int FindNearest(const Vector2f& position) const;
+
+private:
+    struct Entry
+    {
+        Vector2f center;
+        int tower;
+    };
+
+    int FindNearestByScan(const Vector2f& position) const;
+    int GetColumn(float x) const;
+    int GetRow(float y) const;
+
+    float m_CellSize;
+    int m_Columns;
+    int m_Rows;
+    std::vector<uint32_t> m_CellStart;
+    std::vector<Entry> m_Entries;
+};
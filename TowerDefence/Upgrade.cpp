@@ -130,6 +130,30 @@ void Upgrade::Draw(float x, float y, float width, float height, bool isSelected)
     case UpgradeType::RICOCHET:
         typeColor = Color4f(0.8f, 0.3f, 1.0f, 1.0f); // Purple
         break;
+    case UpgradeType::TARGETING:
+        typeColor = Color4f(1.0f, 1.0f, 0.4f, 1.0f); // Yellow
+        break;
+    case UpgradeType::SPLASH:
+        typeColor = Color4f(0.3f, 0.9f, 0.9f, 1.0f); // Cyan
+        break;
+    case UpgradeType::EXPLOSIVE:
+        typeColor = Color4f(1.0f, 0.55f, 0.1f, 1.0f); // Dark orange
+        break;
+    case UpgradeType::CHAIN_LIGHTNING:
+        typeColor = Color4f(0.6f, 0.85f, 1.0f, 1.0f); // Pale blue
+        break;
+    case UpgradeType::FROST:
+        typeColor = Color4f(0.4f, 0.7f, 1.0f, 1.0f); // Ice blue
+        break;
+    case UpgradeType::INCENDIARY:
+        typeColor = Color4f(1.0f, 0.45f, 0.1f, 1.0f); // Flame
+        break;
+    case UpgradeType::VENOM:
+        typeColor = Color4f(0.4f, 0.9f, 0.2f, 1.0f); // Toxic green
+        break;
+    case UpgradeType::CONCUSSION:
+        typeColor = Color4f(0.9f, 0.9f, 0.9f, 1.0f); // White
+        break;
     default:
         typeColor = Color4f(0.5f, 0.5f, 0.5f, 1.0f); // Gray
         break;
@@ -146,6 +170,12 @@ void Upgrade::Draw(float x, float y, float width, float height, bool isSelected)
         oss << std::fixed << std::setprecision(1) << m_Amount;
         amountText = "+" + oss.str();
     }
+    else if (m_Type == UpgradeType::TARGETING) {
+        amountText = "";
+    }
+    else if (m_Type == UpgradeType::FROST || m_Type == UpgradeType::CONCUSSION) {
+        amountText = "+" + std::to_string(static_cast<int>(m_Amount * 100.f + 0.5f)) + "%";
+    }
 
     float badgeSize = 40.f;
     float badgeX = x + width - badgeSize - 10.f;
@@ -211,4 +241,94 @@ Upgrade* Upgrade::CreateRicochetUpgrade(float amount)
             tower.UpgradeRicochet(static_cast<int>(amt));
         }
     );
-}
\ No newline at end of file
+}
+
+Upgrade* Upgrade::CreateTargetingUpgrade()
+{
+    return new Upgrade(
+        UpgradeType::TARGETING,
+        "Target Priority",
+        "Switch to the next targeting mode: nearest, first, strongest, weakest, boss first",
+        1.f,
+        [](Tower& tower, float) { tower.CycleTargetingPolicy(); }
+    );
+}
+
+Upgrade* Upgrade::CreateSplashUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::SPLASH,
+        "Splash",
+        "Hits deal half damage to enemies within " + std::to_string(static_cast<int>(amount)) + " more pixels",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradeSplash(amt); }
+    );
+}
+
+Upgrade* Upgrade::CreateExplosiveUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::EXPLOSIVE,
+        "Explosive Rounds",
+        "Hits explode for " + std::to_string(static_cast<int>(amount)) + " more damage around the target",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradeExplosive(amt); }
+    );
+}
+
+Upgrade* Upgrade::CreateChainLightningUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::CHAIN_LIGHTNING,
+        "Chain Lightning",
+        "Hits arc to " + std::to_string(static_cast<int>(amount)) + " more nearby enemies",
+        amount,
+        [](Tower& tower, float amt) {
+            tower.UpgradeChainLightning(static_cast<int>(amt));
+        }
+    );
+}
+
+Upgrade* Upgrade::CreateFrostUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::FROST,
+        "Frost",
+        "Hit enemies walk " + std::to_string(static_cast<int>(amount * 100.f + 0.5f)) + "% slower for a while",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradeSlow(amt); }
+    );
+}
+
+Upgrade* Upgrade::CreateIncendiaryUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::INCENDIARY,
+        "Incendiary",
+        "Hit enemies burn for " + std::to_string(static_cast<int>(amount)) + " more damage per second",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradeBurn(amt); }
+    );
+}
+
+Upgrade* Upgrade::CreateVenomUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::VENOM,
+        "Venom",
+        "Hits stack poison dealing " + std::to_string(static_cast<int>(amount)) + " more damage per second each",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradePoison(amt); }
+    );
+}
+
+Upgrade* Upgrade::CreateConcussionUpgrade(float amount)
+{
+    return new Upgrade(
+        UpgradeType::CONCUSSION,
+        "Concussion",
+        "Hits have " + std::to_string(static_cast<int>(amount * 100.f + 0.5f)) + "% more chance to stun (not bosses)",
+        amount,
+        [](Tower& tower, float amt) { tower.UpgradeStun(amt); }
+    );
+}
@@ -11,7 +11,15 @@ enum class UpgradeType
     ATTACK_SPEED,
     RANGE,
     REPAIR,
-    RICOCHET
+    RICOCHET,
+    TARGETING,
+    SPLASH,
+    EXPLOSIVE,
+    CHAIN_LIGHTNING,
+    FROST,
+    INCENDIARY,
+    VENOM,
+    CONCUSSION
 };
 
 class Upgrade
@@ -36,6 +44,14 @@ public:
     static Upgrade* CreateRangeUpgrade(float amount);
     static Upgrade* CreateRepairUpgrade(float amount);
     static Upgrade* CreateRicochetUpgrade(float amount);
+    static Upgrade* CreateTargetingUpgrade();
+    static Upgrade* CreateSplashUpgrade(float amount);
+    static Upgrade* CreateExplosiveUpgrade(float amount);
+    static Upgrade* CreateChainLightningUpgrade(float amount);
+    static Upgrade* CreateFrostUpgrade(float amount);
+    static Upgrade* CreateIncendiaryUpgrade(float amount);
+    static Upgrade* CreateVenomUpgrade(float amount);
+    static Upgrade* CreateConcussionUpgrade(float amount);
 
     void SetTexture(Texture* texture) { m_pCardTexture = texture; }
     Texture* GetTexture() const { return m_pCardTexture; }
@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threadCount)
+    : m_pJob{ nullptr }
+    , m_JobCount{ 0 }
+    , m_NextJob{ 0 }
+    , m_BusyWorkers{ 0 }
+    , m_Generation{ 0 }
+    , m_Stopping{ false }
+{
+    if (threadCount <= 0)
+        threadCount = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    for (int i = 0; i < threadCount; ++i)
+        m_Threads.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+        m_Stopping = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread& thread : m_Threads)
+        thread.join();
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& job)
+{
+    if (m_Threads.empty() || count < 2)
+    {
+        for (size_t i = 0; i < count; ++i) job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+        m_pJob = &job;
+        m_JobCount = count;
+        m_NextJob = 0;
+        m_BusyWorkers = static_cast<int>(m_Threads.size());
+        ++m_Generation;
+    }
+    m_WorkReady.notify_all();
+
+    RunJobs();
+
+    std::unique_lock<std::mutex> lock{ m_Mutex };
+    m_WorkDone.wait(lock, [this]() { return m_BusyWorkers == 0; });
+    m_pJob = nullptr;
+}
+
+void WorkerPool::WorkerLoop()
+{
+    unsigned seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{ m_Mutex };
+            m_WorkReady.wait(lock, [this, seenGeneration]() { return m_Stopping || m_Generation != seenGeneration; });
+            if (m_Stopping) return;
+            seenGeneration = m_Generation;
+        }
+
+        RunJobs();
+
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+            --m_BusyWorkers;
+        }
+        m_WorkDone.notify_one();
+    }
+}
+
+void WorkerPool::RunJobs()
+{
+    while (true)
+    {
+        size_t index = m_NextJob.fetch_add(1);
+        if (index >= m_JobCount) return;
+        (*m_pJob)(index);
+    }
+}
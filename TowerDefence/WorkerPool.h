@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small persistent thread pool for data-parallel loops inside a tick. The
+// threads sleep between calls, so there is no thread creation per tick.
+class WorkerPool
+{
+public:
+    // threadCount 0 uses one thread per hardware core besides the caller
+    explicit WorkerPool(int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool& other) = delete;
+    WorkerPool& operator=(const WorkerPool& other) = delete;
+
+    // Calls job(i) for every i in [0, count) and returns once all calls are
+    // done. The calling thread helps. Jobs must not touch each other's data.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& job);
+
+    int GetThreadCount() const { return static_cast<int>(m_Threads.size()); }
+
+private:
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread> m_Threads;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkReady;
+    std::condition_variable m_WorkDone;
+    const std::function<void(size_t)>* m_pJob;
+    size_t m_JobCount;
+    std::atomic<size_t> m_NextJob;
+    int m_BusyWorkers;
+    unsigned m_Generation;
+    bool m_Stopping;
+};
@@ -3,16 +3,82 @@
 #include <SDL.h>
 #include <ctime>
 #include <iostream>
+#include <string>
+#include <cstdlib>
 #include "Game.h"
+#include "Random.h"
+#include "Replay.h"
+#include "StateHash.h"
+#include "Scenario.h"
 
 void StartHeapControl();
 void DumpMemoryLeaks();
 
 int SDL_main(int argc, char** argv)
 {
-    srand(static_cast<unsigned int>(time(nullptr)));
     StartHeapControl();
 
+    // Command line:
+    //   --seed <n>        seed the simulation RNG
+    //   --record <file>   record this run to a replay file
+    //   --play <file>     play a replay back at max speed
+    //   --headless        with --play or --scenario: simulate without rendering
+    //   --hash-log <file> write a state hash for every tick
+    //   --compare-hashes <a> <b>  report the first tick where two hash logs differ
+    //   --load-snapshot <file>    start from a saved game instead of wave 1
+    //   --benchmark <n>   time the enemy update with n enemies and exit
+    //   --towers <n>      with --benchmark: place n extra towers
+    //   --scaling         with --benchmark: repeat at 1/8, 1/4 and 1/2 of n to show the cost per enemy
+    //   --scenario <name> start from a preset stress scenario and print its per-phase timings
+    //   --horde           horde mode: waves a hundred times larger
+    uint32_t seed = static_cast<uint32_t>(time(nullptr));
+    std::string recordPath;
+    std::string playPath;
+    std::string hashLogPath;
+    std::string snapshotPath;
+    bool headless = false;
+    int benchmarkEnemies = 0;
+    int benchmarkTowers = 0;
+    bool benchmarkScaling = false;
+    std::string scenarioName;
+    bool horde = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--play" && i + 1 < argc) playPath = argv[++i];
+        else if (arg == "--headless") headless = true;
+        else if (arg == "--hash-log" && i + 1 < argc) hashLogPath = argv[++i];
+        else if (arg == "--load-snapshot" && i + 1 < argc) snapshotPath = argv[++i];
+        else if (arg == "--benchmark" && i + 1 < argc) benchmarkEnemies = std::atoi(argv[++i]);
+        else if (arg == "--towers" && i + 1 < argc) benchmarkTowers = std::atoi(argv[++i]);
+        else if (arg == "--scaling") benchmarkScaling = true;
+        else if (arg == "--scenario" && i + 1 < argc) scenarioName = argv[++i];
+        else if (arg == "--horde") horde = true;
+        else if (arg == "--compare-hashes" && i + 2 < argc) {
+            bool identical = StateHashLog::Compare(argv[i + 1], argv[i + 2]);
+            return identical ? 0 : 1;
+        }
+        else std::cerr << "Unknown argument: " << arg << std::endl;
+    }
+    Random::Seed(seed);
+
+    const Scenario* pScenario = nullptr;
+    if (!scenarioName.empty()) {
+        pScenario = Scenarios::Find(scenarioName);
+        if (!pScenario) {
+            std::cerr << "Unknown scenario: " << scenarioName << ", available are:" << std::endl;
+            Scenarios::Print(std::cerr);
+            return -1;
+        }
+    }
+
+    Replay replay;
+    if (!playPath.empty() && !replay.LoadFromFile(playPath)) {
+        return -1;
+    }
+
     // Initialize SDL first
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
@@ -30,13 +96,60 @@ int SDL_main(int argc, char** argv)
     float screenWidth = static_cast<float>(displayMode.w);
     float screenHeight = static_cast<float>(displayMode.h);
 
+    // Spawn positions depend on the window size, so playback must use the recorded one
+    if (!playPath.empty()) {
+        screenWidth = replay.GetWidth();
+        screenHeight = replay.GetHeight();
+    }
+
     std::cout << "Detected screen resolution: " << screenWidth << "x" << screenHeight << std::endl;
 
     // Create game with fullscreen dimensions
     Game* pGame{ new Game{ Window{ "Tower Defence - Meyen, Xander - 1DAE29", screenWidth, screenHeight } } };
 
-    // Run method will now respect the IsGameRunning() return value
-    pGame->Run();
+    if (horde && playPath.empty()) {
+        pGame->StartHordeMode();
+    }
+
+    if (!snapshotPath.empty() && playPath.empty()) {
+        pGame->LoadSnapshot(snapshotPath);
+    }
+
+    if (pScenario && playPath.empty()) {
+        pGame->LoadScenario(*pScenario);
+    }
+
+    if (!playPath.empty()) {
+        pGame->StartPlayback(replay);
+    }
+    else if (!recordPath.empty()) {
+        std::cout << "Recording replay with seed " << seed << " to " << recordPath << std::endl;
+        pGame->StartRecording(recordPath);
+    }
+
+    if (!hashLogPath.empty()) {
+        pGame->StartHashLog(hashLogPath);
+    }
+
+    if (benchmarkEnemies > 0) {
+        SDL_HideWindow(SDL_GL_GetCurrentWindow());
+        if (benchmarkScaling)
+            pGame->RunScalingBenchmark(benchmarkEnemies, 300);
+        else
+            pGame->RunBenchmark(benchmarkEnemies, 300, benchmarkTowers);
+    }
+    else if (!playPath.empty() && headless) {
+        SDL_HideWindow(SDL_GL_GetCurrentWindow());
+        pGame->RunHeadless();
+    }
+    else if (pScenario && headless) {
+        SDL_HideWindow(SDL_GL_GetCurrentWindow());
+        pGame->RunScenario();
+    }
+    else {
+        // Run method will now respect the IsGameRunning() return value
+        pGame->Run();
+    }
 
     delete pGame;
 